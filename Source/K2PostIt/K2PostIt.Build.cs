@@ -46,6 +46,7 @@ public class K2PostIt : ModuleRules
 				"Engine",
 				"GraphEditor",
 				"InputCore",
+				"Json",
 				"KismetWidgets", 
 				"LiveCoding",
 				"Projects",
@@ -4,253 +4,61 @@
 
 #include "Async/Async.h"
 #include "Internationalization/Regex.h"
-#include "K2PostIt/K2PostItColor.h"
-#include "K2PostIt/K2PostItDecorator_InlineCode.h"
-#include "K2PostIt/K2PostItStyle.h"
-#include "K2PostIt/Widgets/SGraphNode_K2PostIt.h"
-#include "K2PostIt/Globals/K2PostItConstants.h"
-#include "K2PostIt/Globals/K2PostItFunctions.h"
+#include "K2PostIt/K2PostItParseCache.h"
+#include "K2PostIt/K2PostItProjectSettings.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
 #include "Tasks/Task.h"
-#include "Widgets/Layout/SBox.h"
-#include "Widgets/Layout/SSeparator.h"
-#include "Widgets/SBoxPanel.h"
-#include "Widgets/Text/SRichTextBlock.h"
 
 #define LOCTEXT_NAMESPACE "K2PostIt"
 
 // ================================================================================================
 
-void FK2PostIt_BaseBlock::SetParentWidget(TSharedPtr<SGraphNode_K2PostIt> GraphNodeK2PostIt)
+namespace K2PostIt::Parser
 {
-	OwnerWidget = GraphNodeK2PostIt.ToWeakPtr();
-}
-
-// ------------------------------------------------------------------------------------------------
-
-UEdGraphNode_K2PostIt* FK2PostIt_BaseBlock::GetOwnerNode() const
-{
-	if (OwnerWidget.IsValid())
+	/** Times a parse and reports it if it ran slower than the configured threshold for its input length. Slow parses of real user text are the main thing that can hitch the editor. */
+	struct FScopedSlowParseWatchdog
 	{
-		UEdGraphNode_K2PostIt* OwnerNode = OwnerWidget.Pin()->GetNodeObjAsK2PostIt();
-
-		if (IsValid(OwnerNode))
+		FScopedSlowParseWatchdog(const FString& InText)
+			: Text(InText)
+			, StartTime(FPlatformTime::Seconds())
 		{
-			return OwnerNode;
 		}
-	}
-
-	return nullptr;
-}
-
-// ================================================================================================
 
-TSharedPtr<SWidget> FK2PostIt_TextBlock::Draw() const
-{	
-	return SNew(SBorder)
-	.BorderImage(FK2PostItStyle::GetImageBrush(K2PostItBrushes.None))
-	.Padding(0)
-	.ForegroundColor_Raw(this, &FK2PostIt_TextBlock::GetForegroundColor)
-	[
-		SNew(SRichTextBlock)
-		.TextStyle(FK2PostItStyle::Get(), K2PostItStyles.TextStyle_Normal)
-		.DecoratorStyleSet( &FK2PostItStyle::Get() )
-		.Text(FText::FromString(Text))
-		.LineHeightPercentage(K2PostIt::Constants::MarkdownPanelLineHeightSpacing)
-		.WrappingPolicy(ETextWrappingPolicy::DefaultWrapping)
-		.WrapTextAt_Lambda( [this] ()
+		~FScopedSlowParseWatchdog()
 		{
-			if (OwnerWidget.IsValid())
-			{
-				return (float)(OwnerWidget.Pin()->GetWrapAt());
-			}
-			return -1.0f;
-		})
-		+ SRichTextBlock::Decorator(FK2PostItDecorator_InlineCode::Create("K2PostIt.Code", OwnerWidget.Pin()))
-		+ SRichTextBlock::Decorator(SRichTextBlock::HyperlinkDecorator("browser", FSlateHyperlinkRun::FOnClick::CreateStatic(&K2PostIt::OnBrowserLinkClicked)))
-	];
-}
-
-// ------------------------------------------------------------------------------------------------
-
-FSlateColor FK2PostIt_TextBlock::GetForegroundColor() const
-{
-	FLinearColor Color = K2PostItColor::Error;
-
-	if (UEdGraphNode_K2PostIt* OwnerNode = GetOwnerNode())
-	{
-		Color = K2PostItColor::GetNominalFontColor(OwnerNode->CommentColor, K2PostItColor::White, K2PostItColor::Noir);
-	}
-		
-	return Color;
-}
-
-// ================================================================================================
+			const double Elapsed = FPlatformTime::Seconds() - StartTime;
+			const double Threshold = UK2PostItProjectSettings::GetSlowParseThreshold(Text.Len());
 
-TSharedPtr<SWidget> FK2PostIt_SeparatorBlock::Draw() const
-{
-	return SNew(SBox)
-	.HAlign(HAlign_Fill)
-	.Padding(K2PostIt::Constants::Separator_SidePadding, K2PostIt::Constants::Separator_TopPadding, K2PostIt::Constants::Separator_SidePadding, K2PostIt::Constants::Separator_BottomPadding)
-	[
-		SNew(SSeparator)
-		.Thickness(2)
-		.SeparatorImage(FK2PostItStyle::GetImageBrush(K2PostItBrushes.Separator))
-		.ColorAndOpacity_Lambda( [this] ()
-		{
-			if (UEdGraphNode_K2PostIt* Owner = GetOwnerNode())
+			if (Elapsed <= Threshold)
 			{
-				if (Owner->CommentColor.GetLuminance() < K2PostIt::Constants::LuminanceDarkModeThreshold)
-				{
-					return K2PostItColor::DimWhite_SemiGlass;
-				}
+				return;
 			}
 
-			return K2PostItColor::Noir_SemiGlass;
-		})
-	];
-}
-
-// ================================================================================================
-
-TSharedPtr<SWidget> FK2PostIt_CodeBlock::Draw() const
-{
-	return SNew(SBox)
-	.Padding(0, K2PostIt::Constants::CodeBlock_TopPadding, 0, K2PostIt::Constants::CodeBlock_BottomPadding)
-	[
-		// TODO this duplicates some code with K2PostItDecorator_InlineCode, I should pull out into something common
-		SNew(SBorder)
-		.BorderImage(FK2PostItStyle::GetImageBrush(K2PostItBrushes.CodeHighlightFill))
-		.ForegroundColor_Lambda( [this] ()
-		{
-			FLinearColor Color = K2PostItColor::Noir;
-	
-			if (UEdGraphNode_K2PostIt* Owner = GetOwnerNode())
-			{
-				Color = K2PostItColor::GetNominalFontColor(Owner->CommentColor, K2PostItColor::White, K2PostItColor::Noir);
-			}
+			const uint32 Hash = GetTypeHash(Text);
 			
-			return Color;
-		})
-		.BorderBackgroundColor_Lambda( [this] ()
-		{
-			FLinearColor Color = K2PostItColor::White;
-	
-			if (UEdGraphNode_K2PostIt* Owner = GetOwnerNode())
-			{
-				float Alpha = Color.A;
-				Color = Owner->CommentColor * K2PostIt::Constants::CodeBlock_BorderBackgroundColorMulti;
-				Color.A = Alpha;
-			}
-			
-			return Color;
-		})
-		.Padding(0)
-		[
-			SNew(SBorder)
-			.Padding(K2PostIt::Constants::CodeBlock_InternalPadding)
-			.BorderImage(FK2PostItStyle::GetImageBrush(K2PostItBrushes.CodeHighlightBorder))
-			.BorderBackgroundColor_Lambda( [this] ()
-			{
-				FLinearColor Color = K2PostItColor::White;
-	
-				if (UEdGraphNode_K2PostIt* Owner = GetOwnerNode())
-				{
-					float Lum = Owner->CommentColor.GetLuminance() + K2PostIt::Constants::CodeBlock_BorderBrighten;
-					Color = FLinearColor(Lum, Lum, Lum, 1.0f);
-				}
-			
-				return Color;
-			})
-			[
-				SNew(SRichTextBlock)
-				.TextStyle(FK2PostItStyle::Get(), K2PostItStyles.TextStyle_CodeBlock)
-				.DecoratorStyleSet( &FK2PostItStyle::Get() )
-				.Text(FText::FromString(Text))
-				.LineHeightPercentage(K2PostIt::Constants::MarkdownPanelLineHeightSpacing)
-				.WrappingPolicy(ETextWrappingPolicy::DefaultWrapping)
-				.WrapTextAt_Lambda( [this] ()
-				{
-					if (OwnerWidget.IsValid())
-					{
-						return (float)(OwnerWidget.Pin()->GetWrapAt());
-					}
-					return -1.0f;
-				})
-			]	
-		]
-	];
-}
-
-// ================================================================================================
-
-TSharedPtr<SWidget> FK2PostIt_BulletBlock::Draw() const
-{
-	const FString Bullets[3] { TEXT("\u2756"), TEXT("\u25CF"), TEXT("\u25CB")};
-	const float IndentFactor = K2PostIt::Constants::BulletIndentFactor;
-	const int32 SpacesPerIndent = 2;
-	
-	int32 EffectiveIndentLevel = FMath::Clamp(IndentLevel / SpacesPerIndent, 0, 2);
+			UE_LOG(LogTemp, Warning, TEXT("K2PostIt: slow parse, %d characters took %.1f ms (threshold %.1f ms), input hash %08x"), Text.Len(), Elapsed * 1000.0, Threshold * 1000.0, Hash);
 
-	const float TotalIndent = IndentFactor * EffectiveIndentLevel + K2PostIt::Constants::BulletBaseIndent;
-	
-	return SNew(SBorder)
-	.Padding(TotalIndent, K2PostIt::Constants::BulletTopPadding, 0, 0)
-	.BorderImage(FK2PostItStyle::GetImageBrush(K2PostItBrushes.None))
-	.ForegroundColor_Lambda( [this] ()
-	{
-		FLinearColor Color = K2PostItColor::Noir;
+			if (UK2PostItProjectSettings::GetSaveSlowParseInputs())
+			{
+				const FString FilePath = FPaths::ProjectSavedDir() / TEXT("K2PostIt") / TEXT("SlowParses") / FString::Printf(TEXT("%08x.md"), Hash);
 
-		if (UEdGraphNode_K2PostIt* Owner = GetOwnerNode())
-		{
-			Color = K2PostItColor::GetNominalFontColor(Owner->CommentColor, K2PostItColor::DimWhite, K2PostItColor::DeepGray);
+				FFileHelper::SaveStringToFile(Text, *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+			}
 		}
-	
-		return Color;
-	})
-	[
-		SNew(SHorizontalBox)
-		+ SHorizontalBox::Slot()
-		.AutoWidth()
-		.Padding(0, 0, 0, 0)
-		[
-			SNew(SBox)
-			.WidthOverride(K2PostIt::Constants::BulletSymbolWidth)
-			.HAlign(HAlign_Left)
-			[
-				SNew(SRichTextBlock)
-				.TextStyle(FK2PostItStyle::Get(), K2PostItStyles.TextStyle_Normal)
-				.DecoratorStyleSet( &FK2PostItStyle::Get() )
-				.Text(FText::FromString(Bullets[EffectiveIndentLevel]))
-				.LineHeightPercentage(K2PostIt::Constants::MarkdownPanelLineHeightSpacing)
-			]
-		]
-		+ SHorizontalBox::Slot()
-		[
-			SNew(SRichTextBlock)
-			.TextStyle(FK2PostItStyle::Get(), K2PostItStyles.TextStyle_Normal)
-			.DecoratorStyleSet( &FK2PostItStyle::Get() )
-			.Text(FText::FromString(Text))
-			.LineHeightPercentage(K2PostIt::Constants::MarkdownPanelLineHeightSpacing)
-			.WrappingPolicy(ETextWrappingPolicy::DefaultWrapping)
-			.WrapTextAt_Lambda( [this, TotalIndent] ()
-			{
-				if (OwnerWidget.IsValid())
-				{
-					return (float)(OwnerWidget.Pin()->GetWrapAt() - TotalIndent - K2PostIt::Constants::BulletSymbolWidth);
-				}
-				return -1.0f;
-			})
-			+ SRichTextBlock::Decorator(FK2PostItDecorator_InlineCode::Create("K2PostIt.Code", OwnerWidget.Pin()))
-			+ SRichTextBlock::Decorator(SRichTextBlock::HyperlinkDecorator("browser", FSlateHyperlinkRun::FOnClick::CreateStatic(&K2PostIt::OnBrowserLinkClicked)))
-		]
-	];
+
+		const FString& Text;
+		
+		double StartTime;
+	};
 }
 
 // ================================================================================================
 
-FK2PostItAsyncParser::FK2PostItAsyncParser(const FString& InString)
+FK2PostItAsyncParser::FK2PostItAsyncParser(const FText& InText)
+	: TextToParse(InText)
 {
-	StringToParse = InString;
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -262,18 +70,23 @@ void FK2PostItAsyncParser::RunParser()
 	Task = UE::Tasks::Launch(UE_SOURCE_LOCATION,
 		[WeakThisAsync]
 		{
-			BlockArray NewBlocks;
+			FK2PostItDocumentPtr NewDocument;
 
 			if (TSharedPtr<FK2PostItAsyncParser> SharedThis = (WeakThisAsync.Pin()))
 			{
-				PeasantTextToRichText(SharedThis->StringToParse, NewBlocks);
+				TSharedRef<FK2PostItDocument> Parsed = MakeShared<FK2PostItDocument>();
+				PeasantTextToRichText(SharedThis->TextToParse.ToString(), *Parsed);
+
+				NewDocument = FK2PostItParseCache::Add(SharedThis->TextToParse.ToString(), Parsed);
 			}
 			
-			AsyncTask(ENamedThreads::GameThread, [WeakThisAsync, NewBlocks]
+			AsyncTask(ENamedThreads::GameThread, [WeakThisAsync, NewDocument]
 			{
-				if (TSharedPtr<FK2PostItAsyncParser> SharedThis = (WeakThisAsync.Pin()))
+				TSharedPtr<FK2PostItAsyncParser> SharedThis = WeakThisAsync.Pin();
+
+				if (SharedThis.IsValid() && NewDocument.IsValid())
 				{
-					 SharedThis->OnParseComplete.Broadcast(NewBlocks);
+					 SharedThis->OnParseComplete.Broadcast(NewDocument.ToSharedRef());
 				}
 			});
 		},
@@ -286,6 +99,10 @@ void FK2PostItAsyncParser::RunParser()
 
 void FK2PostItAsyncParser::PeasantTextToRichText(const FString& PeasantText, TArray<TInstancedStruct<FK2PostIt_BaseBlock>>& Blocks)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(K2PostIt_PeasantTextToRichText);
+
+	K2PostIt::Parser::FScopedSlowParseWatchdog Watchdog(PeasantText);
+	
 	// Seed with our initial state
 	Blocks.Empty();
 	Blocks.Add(TInstancedStruct<FK2PostIt_BaseBlock>::Make<FK2PostIt_TextBlock>(PeasantText));
@@ -596,6 +413,17 @@ void FK2PostItAsyncParser::PeasantTextToRichText(const FString& PeasantText, TAr
 
 // ------------------------------------------------------------------------------------------------
 
+void FK2PostItAsyncParser::PeasantTextToRichText(const FString& PeasantText, FK2PostItDocument& Document)
+{
+	BlockArray Blocks;
+	PeasantTextToRichText(PeasantText, Blocks);
+
+	Document = FK2PostItDocument::FromBlocks(Blocks);
+	Document.SetParserVersion(Version);
+}
+
+// ------------------------------------------------------------------------------------------------
+
 void FK2PostItAsyncParser::ProcessTextBlocks(FString RegexPattern, BlockParserDelegate F, TArray<TInstancedStruct<FK2PostIt_BaseBlock>>& Blocks)
 {
 	for (int32 i = 0; i < Blocks.Num(); ++i)
@@ -0,0 +1,157 @@
+// Unlicensed. This file is public domain.
+
+#include "K2PostIt/K2PostItBlockWidgetPool.h"
+
+#include "K2PostIt/Globals/K2PostItConstants.h"
+#include "Misc/CoreDelegates.h"
+#include "Widgets/SWidget.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+TSharedRef<SWidget> FK2PostItBlockWidgetPool::Acquire(const FK2PostItBlockView& Block, const FK2PostItRenderContextRef& Context)
+{
+	check(IsInGameThread());
+
+	FK2PostItBlockWidgetPool& Pool = Get();
+	TArray<FK2PostItBlockWidget>& FreeList = Pool.Free[static_cast<uint8>(Block.GetType())];
+
+	FK2PostItBlockWidget Widget = FreeList.Num() > 0 ? FreeList.Pop(EAllowShrinking::No) : FK2PostItBlockWidget();
+
+	if (!Widget.Root.IsValid())
+	{
+		Widget.Type = Block.GetType();
+		K2PostIt::BlockWidgets::BuildBlock(Widget);
+	}
+
+	K2PostIt::BlockWidgets::BindBlock(Widget, Block, Context);
+
+	TSharedRef<SWidget> Root = Widget.Root.ToSharedRef();
+	Pool.InUse.Add(&Root.Get(), MoveTemp(Widget));
+	Pool.bUsedSinceTick = true;
+
+	if (!Pool.TickerHandle.IsValid())
+	{
+		Pool.TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(&Pool, &FK2PostItBlockWidgetPool::Tick), K2PostIt::Constants::BlockWidgetPoolTrimInterval);
+	}
+
+	return Root;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FK2PostItBlockWidgetPool::Release(const TSharedRef<SWidget>& Widget)
+{
+	check(IsInGameThread());
+
+	FK2PostItBlockWidgetPool& Pool = Get();
+
+	if (FK2PostItBlockWidget* Released = Pool.InUse.Find(&Widget.Get()))
+	{
+		Pool.Recycle(MoveTemp(*Released));
+		Pool.InUse.Remove(&Widget.Get());
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FK2PostItBlockWidgetPool::Restyle(const TSharedRef<SWidget>& Widget)
+{
+	check(IsInGameThread());
+
+	if (FK2PostItBlockWidget* Found = Get().InUse.Find(&Widget.Get()))
+	{
+		K2PostIt::BlockWidgets::StyleBlock(*Found);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FK2PostItBlockWidgetPool::Empty()
+{
+	check(IsInGameThread());
+
+	FK2PostItBlockWidgetPool& Pool = Get();
+
+	Pool.InUse.Empty();
+
+	for (TArray<FK2PostItBlockWidget>& FreeList : Pool.Free)
+	{
+		FreeList.Empty();
+	}
+
+	if (Pool.TickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(Pool.TickerHandle);
+		Pool.TickerHandle.Reset();
+	}
+
+	Pool.bUsedSinceTick = false;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FK2PostItBlockWidgetPool& FK2PostItBlockWidgetPool::Get()
+{
+	static FK2PostItBlockWidgetPool Instance;
+
+	// Slate widgets must not outlive Slate
+	static const FDelegateHandle PreExitHandle = FCoreDelegates::OnPreExit.AddStatic(&FK2PostItBlockWidgetPool::Empty);
+
+	return Instance;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FK2PostItBlockWidgetPool::Tick(float DeltaTime)
+{
+	// Widgets whose owner was destroyed without releasing them are only referenced from here
+	for (auto It = InUse.CreateIterator(); It; ++It)
+	{
+		if (It.Value().Root.IsUnique())
+		{
+			Recycle(MoveTemp(It.Value()));
+			It.RemoveCurrent();
+		}
+	}
+
+	bool bEmpty = InUse.IsEmpty();
+
+	for (TArray<FK2PostItBlockWidget>& FreeList : Free)
+	{
+		if (!bUsedSinceTick)
+		{
+			FreeList.SetNum(FreeList.Num() / 2, EAllowShrinking::Yes);
+		}
+
+		bEmpty &= FreeList.IsEmpty();
+	}
+
+	bUsedSinceTick = false;
+
+	if (bEmpty)
+	{
+		TickerHandle.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FK2PostItBlockWidgetPool::Recycle(FK2PostItBlockWidget&& Widget)
+{
+	TArray<FK2PostItBlockWidget>& FreeList = Free[static_cast<uint8>(Widget.Type)];
+
+	if (FreeList.Num() < K2PostIt::Constants::BlockWidgetPoolMaxPerType)
+	{
+		K2PostIt::BlockWidgets::UnbindBlock(Widget);
+		FreeList.Add(MoveTemp(Widget));
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#undef LOCTEXT_NAMESPACE
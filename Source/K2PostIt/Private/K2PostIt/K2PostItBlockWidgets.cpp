@@ -0,0 +1,350 @@
+// Unlicensed. This file is public domain.
+
+#include "K2PostIt/K2PostItBlockWidgets.h"
+
+#include "Hash/CityHash.h"
+#include "K2PostIt/K2PostItBlockWidgetPool.h"
+#include "K2PostIt/K2PostItDecorator_InlineCode.h"
+#include "K2PostIt/K2PostItStyle.h"
+#include "K2PostIt/Globals/K2PostItConstants.h"
+#include "K2PostIt/Globals/K2PostItFunctions.h"
+#include "K2PostIt/K2PostItRenderContext.h"
+#include "Widgets/Layout/SBorder.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/Layout/SSeparator.h"
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/Text/SRichTextBlock.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+namespace K2PostIt
+{
+	namespace BlockWidgets
+	{
+		template<EK2PostItBlockType Type>
+		void Build(FK2PostItBlockWidget& Widget);
+
+		template<EK2PostItBlockType Type>
+		void Bind(FK2PostItBlockWidget& Widget, const FK2PostItBlockView& Block);
+
+		template<EK2PostItBlockType Type>
+		void Style(FK2PostItBlockWidget& Widget, const FK2PostItRenderContext& Context);
+
+		// ----------------------------------------------------------------------------------------
+
+		/** Inline code runs take the comment color when they are created, so the text has to be laid out again when it changes */
+		static void RefreshDecorators(FK2PostItBlockWidget& Widget, const FK2PostItRenderContext& Context)
+		{
+			if (Widget.StyledColor != Context.GetCommentColor())
+			{
+				Widget.Text->Refresh();
+			}
+		}
+
+		// ----------------------------------------------------------------------------------------
+
+		template<>
+		void Build<EK2PostItBlockType::Text>(FK2PostItBlockWidget& Widget)
+		{
+			Widget.Root = SAssignNew(Widget.Border, SBorder)
+			.BorderImage(FK2PostItStyle::GetImageBrush(K2PostItBrushes.None))
+			.Padding(0)
+			[
+				SAssignNew(Widget.Text, SRichTextBlock)
+				.TextStyle(FK2PostItStyle::Get(), K2PostItStyles.TextStyle_Normal)
+				.DecoratorStyleSet( &FK2PostItStyle::Get() )
+				.LineHeightPercentage(K2PostIt::Constants::MarkdownPanelLineHeightSpacing)
+				.WrappingPolicy(ETextWrappingPolicy::DefaultWrapping)
+				+ SRichTextBlock::Decorator(FK2PostItDecorator_InlineCode::Create("K2PostIt.Code", Widget.Binding))
+				+ SRichTextBlock::Decorator(SRichTextBlock::HyperlinkDecorator("browser", FSlateHyperlinkRun::FOnClick::CreateStatic(&K2PostIt::OnBrowserLinkClicked)))
+			];
+		}
+
+		template<>
+		void Bind<EK2PostItBlockType::Text>(FK2PostItBlockWidget& Widget, const FK2PostItBlockView& Block)
+		{
+			Widget.Text->SetText(FText::FromStringView(Block.GetText()));
+		}
+
+		template<>
+		void Style<EK2PostItBlockType::Text>(FK2PostItBlockWidget& Widget, const FK2PostItRenderContext& Context)
+		{
+			Widget.Border->SetForegroundColor(Context.GetTheme().FontColor);
+			Widget.Text->SetWrapTextAt(Widget.Binding->GetWrapAt());
+
+			RefreshDecorators(Widget, Context);
+		}
+
+		// ----------------------------------------------------------------------------------------
+
+		template<>
+		void Build<EK2PostItBlockType::Separator>(FK2PostItBlockWidget& Widget)
+		{
+			Widget.Root = SNew(SBox)
+			.HAlign(HAlign_Fill)
+			.Padding(K2PostIt::Constants::Separator_SidePadding, K2PostIt::Constants::Separator_TopPadding, K2PostIt::Constants::Separator_SidePadding, K2PostIt::Constants::Separator_BottomPadding)
+			[
+				SAssignNew(Widget.Border, SSeparator)
+				.Thickness(2)
+				.SeparatorImage(FK2PostItStyle::GetImageBrush(K2PostItBrushes.Separator))
+			];
+		}
+
+		template<>
+		void Bind<EK2PostItBlockType::Separator>(FK2PostItBlockWidget& Widget, const FK2PostItBlockView& Block)
+		{
+		}
+
+		template<>
+		void Style<EK2PostItBlockType::Separator>(FK2PostItBlockWidget& Widget, const FK2PostItRenderContext& Context)
+		{
+			// SSeparator draws its line as the border background
+			Widget.Border->SetBorderBackgroundColor(Context.GetTheme().SeparatorColor);
+		}
+
+		// ----------------------------------------------------------------------------------------
+
+		template<>
+		void Build<EK2PostItBlockType::Code>(FK2PostItBlockWidget& Widget)
+		{
+			Widget.Root = SNew(SBox)
+			.Padding(0, K2PostIt::Constants::CodeBlock_TopPadding, 0, K2PostIt::Constants::CodeBlock_BottomPadding)
+			[
+				// TODO this duplicates some code with K2PostItDecorator_InlineCode, I should pull out into something common
+				SAssignNew(Widget.Border, SBorder)
+				.BorderImage(FK2PostItStyle::GetImageBrush(K2PostItBrushes.CodeHighlightFill))
+				.Padding(0)
+				[
+					SAssignNew(Widget.InnerBorder, SBorder)
+					.Padding(K2PostIt::Constants::CodeBlock_InternalPadding)
+					.BorderImage(FK2PostItStyle::GetImageBrush(K2PostItBrushes.CodeHighlightBorder))
+					[
+						SAssignNew(Widget.Text, SRichTextBlock)
+						.TextStyle(FK2PostItStyle::Get(), K2PostItStyles.TextStyle_CodeBlock)
+						.DecoratorStyleSet( &FK2PostItStyle::Get() )
+						.LineHeightPercentage(K2PostIt::Constants::MarkdownPanelLineHeightSpacing)
+						.WrappingPolicy(ETextWrappingPolicy::DefaultWrapping)
+					]
+				]
+			];
+		}
+
+		template<>
+		void Bind<EK2PostItBlockType::Code>(FK2PostItBlockWidget& Widget, const FK2PostItBlockView& Block)
+		{
+			Widget.Text->SetText(FText::FromStringView(Block.GetText()));
+		}
+
+		template<>
+		void Style<EK2PostItBlockType::Code>(FK2PostItBlockWidget& Widget, const FK2PostItRenderContext& Context)
+		{
+			const FK2PostItTheme& Theme = Context.GetTheme();
+
+			Widget.Border->SetForegroundColor(Theme.FontColor);
+			Widget.Border->SetBorderBackgroundColor(Theme.CodeBlockFillColor);
+			Widget.InnerBorder->SetBorderBackgroundColor(Theme.CodeBlockBorderColor);
+			Widget.Text->SetWrapTextAt(Widget.Binding->GetWrapAt());
+		}
+
+		// ----------------------------------------------------------------------------------------
+
+		template<>
+		void Build<EK2PostItBlockType::Bullet>(FK2PostItBlockWidget& Widget)
+		{
+			Widget.Root = SAssignNew(Widget.IndentBorder, SBorder)
+			.BorderImage(FK2PostItStyle::GetImageBrush(K2PostItBrushes.None))
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.Padding(0, 0, 0, 0)
+				[
+					SNew(SBox)
+					.WidthOverride(K2PostIt::Constants::BulletSymbolWidth)
+					.HAlign(HAlign_Left)
+					[
+						SAssignNew(Widget.BulletSymbol, SRichTextBlock)
+						.TextStyle(FK2PostItStyle::Get(), K2PostItStyles.TextStyle_Normal)
+						.DecoratorStyleSet( &FK2PostItStyle::Get() )
+						.LineHeightPercentage(K2PostIt::Constants::MarkdownPanelLineHeightSpacing)
+					]
+				]
+				+ SHorizontalBox::Slot()
+				[
+					SAssignNew(Widget.Text, SRichTextBlock)
+					.TextStyle(FK2PostItStyle::Get(), K2PostItStyles.TextStyle_Normal)
+					.DecoratorStyleSet( &FK2PostItStyle::Get() )
+					.LineHeightPercentage(K2PostIt::Constants::MarkdownPanelLineHeightSpacing)
+					.WrappingPolicy(ETextWrappingPolicy::DefaultWrapping)
+					+ SRichTextBlock::Decorator(FK2PostItDecorator_InlineCode::Create("K2PostIt.Code", Widget.Binding))
+					+ SRichTextBlock::Decorator(SRichTextBlock::HyperlinkDecorator("browser", FSlateHyperlinkRun::FOnClick::CreateStatic(&K2PostIt::OnBrowserLinkClicked)))
+				]
+			];
+
+			Widget.Border = Widget.IndentBorder;
+		}
+
+		template<>
+		void Bind<EK2PostItBlockType::Bullet>(FK2PostItBlockWidget& Widget, const FK2PostItBlockView& Block)
+		{
+			const FString Bullets[3] { TEXT("\u2756"), TEXT("\u25CF"), TEXT("\u25CB")};
+			const float IndentFactor = K2PostIt::Constants::BulletIndentFactor;
+			const int32 SpacesPerIndent = 2;
+
+			int32 EffectiveIndentLevel = FMath::Clamp(Block.GetIndentLevel() / SpacesPerIndent, 0, 2);
+
+			const float TotalIndent = IndentFactor * EffectiveIndentLevel + K2PostIt::Constants::BulletBaseIndent;
+
+			Widget.IndentBorder->SetPadding(FMargin(TotalIndent, K2PostIt::Constants::BulletTopPadding, 0, 0));
+			Widget.BulletSymbol->SetText(FText::FromString(Bullets[EffectiveIndentLevel]));
+			Widget.Binding->WrapInset = TotalIndent + K2PostIt::Constants::BulletSymbolWidth;
+			Widget.Text->SetText(FText::FromStringView(Block.GetText()));
+		}
+
+		template<>
+		void Style<EK2PostItBlockType::Bullet>(FK2PostItBlockWidget& Widget, const FK2PostItRenderContext& Context)
+		{
+			Widget.Border->SetForegroundColor(Context.GetTheme().DimFontColor);
+			Widget.Text->SetWrapTextAt(Widget.Binding->GetWrapAt());
+
+			RefreshDecorators(Widget, Context);
+		}
+	}
+}
+
+// ================================================================================================
+
+TSharedRef<SWidget> K2PostIt::BlockWidgets::DrawBlock(const FK2PostItBlockView& Block, const FK2PostItRenderContextRef& Context)
+{
+	return FK2PostItBlockWidgetPool::Acquire(Block, Context);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void K2PostIt::BlockWidgets::ReleaseBlock(const TSharedRef<SWidget>& Widget)
+{
+	FK2PostItBlockWidgetPool::Release(Widget);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void K2PostIt::BlockWidgets::RestyleBlock(const TSharedRef<SWidget>& Widget)
+{
+	FK2PostItBlockWidgetPool::Restyle(Widget);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void K2PostIt::BlockWidgets::BuildBlock(FK2PostItBlockWidget& Widget)
+{
+	switch (Widget.Type)
+	{
+		case EK2PostItBlockType::Separator:	Build<EK2PostItBlockType::Separator>(Widget); break;
+		case EK2PostItBlockType::Code:		Build<EK2PostItBlockType::Code>(Widget); break;
+		case EK2PostItBlockType::Bullet:	Build<EK2PostItBlockType::Bullet>(Widget); break;
+		case EK2PostItBlockType::Text:
+		default:							Build<EK2PostItBlockType::Text>(Widget); break;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void K2PostIt::BlockWidgets::BindBlock(FK2PostItBlockWidget& Widget, const FK2PostItBlockView& Block, const FK2PostItRenderContextRef& Context)
+{
+	check(Widget.Type == Block.GetType());
+
+	Widget.Binding->Context = Context;
+
+	K2PostIt::VisitBlock(Block, [&Widget] (auto Tag, const FK2PostItBlockView& InBlock)
+	{
+		Bind<decltype(Tag)::Type>(Widget, InBlock);
+	});
+
+	StyleBlock(Widget);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void K2PostIt::BlockWidgets::StyleBlock(FK2PostItBlockWidget& Widget)
+{
+	const FK2PostItRenderContext& Context = Widget.Binding->GetContext();
+
+	switch (Widget.Type)
+	{
+		case EK2PostItBlockType::Separator:	Style<EK2PostItBlockType::Separator>(Widget, Context); break;
+		case EK2PostItBlockType::Code:		Style<EK2PostItBlockType::Code>(Widget, Context); break;
+		case EK2PostItBlockType::Bullet:	Style<EK2PostItBlockType::Bullet>(Widget, Context); break;
+		case EK2PostItBlockType::Text:
+		default:							Style<EK2PostItBlockType::Text>(Widget, Context); break;
+	}
+
+	Widget.StyledColor = Context.GetCommentColor();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void K2PostIt::BlockWidgets::UnbindBlock(FK2PostItBlockWidget& Widget)
+{
+	Widget.Binding->Context.Reset();
+
+	if (Widget.Text.IsValid())
+	{
+		Widget.Text->SetText(FText::GetEmpty());
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+uint64 K2PostIt::BlockWidgets::GetBlockKey(const FK2PostItBlockView& Block)
+{
+	const FStringView Text = Block.GetText();
+	const uint64 Seed = static_cast<uint64>(Block.GetType()) | (static_cast<uint64>(Block.GetIndentLevel()) << 8);
+
+	return CityHash64WithSeed(reinterpret_cast<const char*>(Text.GetData()), Text.Len() * sizeof(TCHAR), Seed);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float K2PostIt::BlockWidgets::EstimateBlockHeight(const FK2PostItBlockView& Block, float WrapAt)
+{
+	using namespace K2PostIt::Constants;
+
+	if (Block.GetType() == EK2PostItBlockType::Separator)
+	{
+		return Separator_TopPadding + Separator_BottomPadding;
+	}
+
+	const FStringView Text = Block.GetText();
+	// Without a wrap width the text is not wrapped, and each line of it is one line tall
+	const bool bWraps = WrapAt > 0.0f;
+	const int32 CharsPerLine = bWraps ? FMath::Max(1, FMath::FloorToInt32(WrapAt / BlockEstimate_CharWidth)) : 0;
+
+	int32 NumLines = 0;
+	int32 LineStart = 0;
+
+	for (int32 i = 0; i <= Text.Len(); ++i)
+	{
+		if (i == Text.Len() || Text[i] == TEXT('\n'))
+		{
+			NumLines += bWraps ? FMath::Max(1, FMath::DivideAndRoundUp(i - LineStart, CharsPerLine)) : 1;
+			LineStart = i + 1;
+		}
+	}
+
+	float Height = NumLines * BlockEstimate_LineHeight;
+
+	switch (Block.GetType())
+	{
+		case EK2PostItBlockType::Code:		Height += CodeBlock_TopPadding + CodeBlock_BottomPadding + 2.0f * CodeBlock_InternalPadding; break;
+		case EK2PostItBlockType::Bullet:	Height += BulletTopPadding; break;
+		default:							break;
+	}
+
+	return Height;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#undef LOCTEXT_NAMESPACE
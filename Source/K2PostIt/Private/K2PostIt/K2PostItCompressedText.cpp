@@ -0,0 +1,202 @@
+// Unlicensed. This file is public domain.
+
+#include "K2PostIt/K2PostItCompressedText.h"
+
+#include "K2PostIt/K2PostItProjectSettings.h"
+#include "Misc/Compression.h"
+#include "Serialization/Archive.h"
+#include "UObject/NameTypes.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+namespace K2PostIt::CompressedText
+{
+	/** How the text is stored, written as the first byte */
+	enum class EStoredText : uint8
+	{
+		String,
+		Oodle,
+	};
+
+	/** Largest body that is compressed. Loading rejects larger stored sizes, so a corrupt size cannot make Decompress allocate up to 2 GB. */
+	constexpr int32 MaxUncompressedSize = 16 * 1024 * 1024;
+
+	// --------------------------------------------------------------------------------------------
+
+	static void SerializePacked(FArchive& Ar, int32& Value)
+	{
+		uint32 Packed = static_cast<uint32>(Value);
+		Ar.SerializeIntPacked(Packed);
+		Value = static_cast<int32>(Packed);
+	}
+}
+
+// ================================================================================================
+
+bool FK2PostItCompressedText::ShouldCompress(int32 TextLength)
+{
+	const int32 Threshold = UK2PostItProjectSettings::GetCompressionThreshold();
+
+	return Threshold > 0 && TextLength >= Threshold;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FK2PostItCompressedText::Save(FArchive& Ar, FStringView Text, bool bCompress)
+{
+	check(Ar.IsSaving());
+
+	FK2PostItCompressedText Compressed;
+
+	if (bCompress && Compressed.Compress(Text))
+	{
+		Compressed.Save(Ar);
+		return;
+	}
+
+	uint8 Storage = static_cast<uint8>(K2PostIt::CompressedText::EStoredText::String);
+	Ar << Storage;
+
+	FString String(Text);
+	Ar << String;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FK2PostItCompressedText::Save(FArchive& Ar) const
+{
+	using namespace K2PostIt::CompressedText;
+
+	check(Ar.IsSaving() && !IsEmpty());
+
+	uint8 Storage = static_cast<uint8>(EStoredText::Oodle);
+	int32 StoredUncompressedSize = UncompressedSize;
+	int32 CompressedSize = Data.Num();
+
+	Ar << Storage;
+	SerializePacked(Ar, StoredUncompressedSize);
+	SerializePacked(Ar, CompressedSize);
+	Ar.Serialize(const_cast<uint8*>(Data.GetData()), CompressedSize);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FK2PostItCompressedText::Load(FArchive& Ar, FString& OutText, FK2PostItCompressedText& OutCompressed)
+{
+	using namespace K2PostIt::CompressedText;
+
+	check(Ar.IsLoading());
+
+	OutCompressed.Reset();
+
+	uint8 Storage = 0;
+	Ar << Storage;
+
+	switch (static_cast<EStoredText>(Storage))
+	{
+		case EStoredText::String:
+		{
+			Ar << OutText;
+			return !Ar.IsError();
+		}
+		case EStoredText::Oodle:
+		{
+			int32 StoredUncompressedSize = 0;
+			int32 CompressedSize = 0;
+			SerializePacked(Ar, StoredUncompressedSize);
+			SerializePacked(Ar, CompressedSize);
+
+			if (StoredUncompressedSize < 0 || StoredUncompressedSize > MaxUncompressedSize || CompressedSize <= 0 || (Ar.TotalSize() >= 0 && CompressedSize > Ar.TotalSize() - Ar.Tell()))
+			{
+				Ar.SetError();
+				return false;
+			}
+
+			OutCompressed.Data.SetNumUninitialized(CompressedSize);
+			OutCompressed.UncompressedSize = StoredUncompressedSize;
+			Ar.Serialize(OutCompressed.Data.GetData(), CompressedSize);
+
+			OutText = OutCompressed.Decompress();
+
+			if (Ar.IsError() || (OutText.IsEmpty() && StoredUncompressedSize > 0))
+			{
+				OutCompressed.Reset();
+				return false;
+			}
+
+			return true;
+		}
+		default:
+		{
+			Ar.SetError();
+			return false;
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FK2PostItCompressedText::Compress(FStringView Text)
+{
+	Reset();
+
+	FTCHARToUTF8 Utf8(Text.GetData(), Text.Len());
+	const int32 Utf8Len = Utf8.Length();
+
+	// Anything larger is stored as a plain string, which Load reads back without the size cap
+	if (Utf8Len > K2PostIt::CompressedText::MaxUncompressedSize)
+	{
+		return false;
+	}
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Oodle, Utf8Len);
+	Data.SetNumUninitialized(CompressedSize);
+
+	if (!FCompression::CompressMemory(NAME_Oodle, Data.GetData(), CompressedSize, Utf8.Get(), Utf8Len) || CompressedSize >= Utf8Len)
+	{
+		Reset();
+		return false;
+	}
+
+	Data.SetNum(CompressedSize);
+	Data.Shrink();
+	UncompressedSize = Utf8Len;
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FK2PostItCompressedText::Decompress() const
+{
+	if (IsEmpty())
+	{
+		return FString();
+	}
+
+	TArray<ANSICHAR> Utf8;
+	Utf8.SetNumUninitialized(UncompressedSize);
+
+	if (!FCompression::UncompressMemory(NAME_Oodle, Utf8.GetData(), UncompressedSize, Data.GetData(), Data.Num()))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("K2PostIt: failed to decompress a comment body (%d bytes)"), Data.Num());
+		return FString();
+	}
+
+	FUTF8ToTCHAR Text(Utf8.GetData(), UncompressedSize);
+	return FString(FStringView(Text.Get(), Text.Length()));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FK2PostItCompressedText::Reset()
+{
+	Data.Empty();
+	UncompressedSize = 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,130 @@
+// Unlicensed. This file is public domain.
+
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Engine/Blueprint.h"
+#include "HAL/IConsoleManager.h"
+#include "K2PostIt/K2PostItProjectSettings.h"
+#include "K2PostIt/Nodes/EdGraphNode_K2PostIt.h"
+#include "Misc/ScopedSlowTask.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectIterator.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+/**
+ * Reports how much comment body compression saves in saved packages. Run from the editor console:
+ *
+ *   K2PostIt.ReportCompression       - comment nodes that are currently loaded
+ *   K2PostIt.ReportCompression All   - loads every blueprint under /Game first
+ */
+namespace K2PostIt::CompressionReport
+{
+	struct FPackageStats
+	{
+		int32 NumNodes = 0;
+		int32 NumCompressed = 0;
+		int64 TextBytes = 0;
+		int64 SavedBytes = 0;
+	};
+
+	// --------------------------------------------------------------------------------------------
+
+	static void LoadAllBlueprints()
+	{
+		TArray<FAssetData> Assets;
+		IAssetRegistry::GetChecked().GetAssetsByClass(UBlueprint::StaticClass()->GetClassPathName(), Assets, true);
+
+		Assets.RemoveAll( [] (const FAssetData& Asset)
+		{
+			return !Asset.PackageName.ToString().StartsWith(TEXT("/Game/"));
+		});
+
+		FScopedSlowTask SlowTask(Assets.Num(), LOCTEXT("CompressionReport_Loading", "Loading blueprints for the K2PostIt compression report..."));
+		SlowTask.MakeDialog(true);
+
+		for (const FAssetData& Asset : Assets)
+		{
+			if (SlowTask.ShouldCancel())
+			{
+				break;
+			}
+
+			SlowTask.EnterProgressFrame(1);
+			Asset.GetAsset();
+		}
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	static void RunCompressionReport(const TArray<FString>& Args)
+	{
+		if (Args.Num() > 0 && Args[0].Equals(TEXT("All"), ESearchCase::IgnoreCase))
+		{
+			LoadAllBlueprints();
+		}
+
+		TMap<FName, FPackageStats> Packages;
+		FPackageStats Total;
+
+		for (TObjectIterator<UEdGraphNode_K2PostIt> It; It; ++It)
+		{
+			const UEdGraphNode_K2PostIt* Node = *It;
+
+			if (Node->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject) || !Node->HasCommentText())
+			{
+				continue;
+			}
+
+			const int32 TextBytes = Node->GetCommentTextSize();
+			const int32 SavedBytes = Node->GetSavedCommentTextSize();
+
+			for (FPackageStats* Stats : { &Packages.FindOrAdd(Node->GetPackage()->GetFName()), &Total })
+			{
+				Stats->NumNodes++;
+				Stats->NumCompressed += SavedBytes < TextBytes ? 1 : 0;
+				Stats->TextBytes += TextBytes;
+				Stats->SavedBytes += SavedBytes;
+			}
+		}
+
+		Packages.ValueSort( [] (const FPackageStats& A, const FPackageStats& B)
+		{
+			return A.TextBytes - A.SavedBytes > B.TextBytes - B.SavedBytes;
+		});
+
+		for (const TPair<FName, FPackageStats>& Package : Packages)
+		{
+			if (Package.Value.NumCompressed > 0)
+			{
+				UE_LOG(LogTemp, Display, TEXT("K2PostIt compression: %-64s %4d of %4d nodes  %9lld B -> %9lld B"),
+					*Package.Key.ToString(),
+					Package.Value.NumCompressed,
+					Package.Value.NumNodes,
+					Package.Value.TextBytes,
+					Package.Value.SavedBytes);
+			}
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("K2PostIt compression: %d packages, %d of %d comment bodies compressed (threshold %d chars), %lld B -> %lld B, %lld B saved"),
+			Packages.Num(),
+			Total.NumCompressed,
+			Total.NumNodes,
+			UK2PostItProjectSettings::GetCompressionThreshold(),
+			Total.TextBytes,
+			Total.SavedBytes,
+			Total.TextBytes - Total.SavedBytes);
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	static FAutoConsoleCommand ReportCompressionCommand(
+		TEXT("K2PostIt.ReportCompression"),
+		TEXT("Logs how many bytes comment body compression saves, per package and in total. Pass All to load every blueprint under /Game first."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunCompressionReport));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#undef LOCTEXT_NAMESPACE
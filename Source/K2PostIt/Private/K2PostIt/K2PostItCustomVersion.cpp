@@ -0,0 +1,17 @@
+// Unlicensed. This file is public domain.
+
+#include "K2PostIt/K2PostItCustomVersion.h"
+
+#include "Serialization/CustomVersion.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+const FGuid FK2PostItCustomVersion::GUID(0x5285339C, 0x73BA4B60, 0xBCAA015A, 0xD61AAADA);
+
+static FCustomVersionRegistration GRegisterK2PostItCustomVersion(FK2PostItCustomVersion::GUID, FK2PostItCustomVersion::LatestVersion, TEXT("K2PostItVer"));
+
+// ------------------------------------------------------------------------------------------------
+
+#undef LOCTEXT_NAMESPACE
@@ -5,9 +5,7 @@
 #include "Fonts/FontMeasure.h"
 #include "Framework/Application/SlateApplication.h"
 #include "Framework/Text/SlateWidgetRun.h"
-#include "K2PostIt/K2PostItColor.h"
 #include "K2PostIt/K2PostItStyle.h"
-#include "K2PostIt/Nodes/EdGraphNode_K2PostIt.h"
 #include "Widgets/Layout/SBox.h"
 #include "Widgets/Text/SRichTextBlock.h"
 
@@ -15,11 +13,11 @@
 
 // ================================================================================================
 
-FK2PostItDecorator_InlineCode::FK2PostItDecorator_InlineCode(FString InName, TSharedPtr<SGraphNode_K2PostIt> InOwnerWidget)
+FK2PostItDecorator_InlineCode::FK2PostItDecorator_InlineCode(FString InName, FK2PostItBlockBindingRef InBinding)
 	: TextStyle(FK2PostItStyle::Get().GetWidgetStyle<FTextBlockStyle>(K2PostItStyles.TextStyle_Normal))
+	, Binding(InBinding)
 {
 	RunName = InName;
-	OwnerWidget = InOwnerWidget;
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -72,54 +70,24 @@ TSharedRef<ISlateRun> FK2PostItDecorator_InlineCode::Create(const TSharedRef<cla
 
 TSharedPtr<SWidget> FK2PostItDecorator_InlineCode::CreateDecoratorWidget(const FTextRunInfo& RunInfo, const FTextBlockStyle& DefaultTextStyle) const
 {
+	// Read once here rather than every frame, the owning block widget lays its text out again when the comment color changes
+	const FK2PostItTheme& Theme = Binding->GetContext().GetTheme();
+
 	return SNew(SBox)
 	.Padding(0, 0, 0, 0)
 	.VAlign(VAlign_Center)
 	[
 		SNew(SBorder)
 		.BorderImage(FK2PostItStyle::GetImageBrush(K2PostItBrushes.CodeHighlightFill))
-		.ForegroundColor_Lambda( [this] ()
-		{
-			FLinearColor Color = K2PostItColor::Noir;
-	
-			if (UEdGraphNode_K2PostIt* Owner = GetOwner())
-			{
-				Color = K2PostItColor::GetNominalFontColor(Owner->CommentColor, K2PostItColor::White, K2PostItColor::Noir);
-			}
-			
-			return Color;
-		})
-		.BorderBackgroundColor_Lambda( [this] ()
-		{
-			FLinearColor Color = K2PostItColor::White;
-	
-			if (UEdGraphNode_K2PostIt* Owner = GetOwner())
-			{
-				float Alpha = Color.A;
-				Color = Owner->CommentColor * 5;
-				Color.A = Alpha;
-			}
-			
-			return Color;
-		})
+		.ForegroundColor(Theme.FontColor)
+		.BorderBackgroundColor(Theme.InlineCodeFillColor)
 		.Padding(0)
 		[
 			SNew(SBorder)
 			.Padding(2, 1, 2, 1)
 			.VAlign(VAlign_Bottom)
 			.BorderImage(FK2PostItStyle::GetImageBrush(K2PostItBrushes.CodeHighlightBorder))
-			.BorderBackgroundColor_Lambda( [this] ()
-			{
-				FLinearColor Color = K2PostItColor::White;
-	
-				if (UEdGraphNode_K2PostIt* Owner = GetOwner())
-				{
-					float Lum = Owner->CommentColor.GetLuminance() * 1.2 + 0.15;
-					Color = FLinearColor(Lum, Lum, Lum, 1.0f);
-				}
-			
-				return Color;
-			})
+			.BorderBackgroundColor(Theme.InlineCodeBorderColor)
 			[
 				SNew(SRichTextBlock)
 				.TextStyle(FK2PostItStyle::Get(), K2PostItStyles.TextStyle_CodeBlock)
@@ -133,21 +101,6 @@ TSharedPtr<SWidget> FK2PostItDecorator_InlineCode::CreateDecoratorWidget(const F
 	];
 }
 
-UEdGraphNode_K2PostIt* FK2PostItDecorator_InlineCode::GetOwner() const
-{
-	if (OwnerWidget.IsValid())
-	{
-		UEdGraphNode_K2PostIt* OwnerNode = OwnerWidget.Pin()->GetNodeObjAsK2PostIt();
-
-		if (IsValid(OwnerNode))
-		{
-			return OwnerNode;
-		}
-	}
-
-	return nullptr;
-}
-
 // ------------------------------------------------------------------------------------------------
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
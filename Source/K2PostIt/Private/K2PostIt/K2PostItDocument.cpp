@@ -0,0 +1,465 @@
+// Unlicensed. This file is public domain.
+
+#include "K2PostIt/K2PostItDocument.h"
+
+#include "Hash/CityHash.h"
+#include "K2PostIt/K2PostItAsyncParser.h"
+#include "K2PostIt/K2PostItCustomVersion.h"
+#include "Misc/Crc.h"
+#include "Serialization/Archive.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+namespace K2PostIt::Document
+{
+	/** How a block's text is stored, packed into the high bits of the block's header byte (the low bits hold the block type). */
+	enum class EStoredText : uint8
+	{
+		Empty,
+		SourceRange,
+		Utf8,
+	};
+
+	// --------------------------------------------------------------------------------------------
+
+	static void SerializePacked(FArchive& Ar, int32& Value)
+	{
+		uint32 Packed = static_cast<uint32>(Value);
+		Ar.SerializeIntPacked(Packed);
+		Value = static_cast<int32>(Packed);
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	static uint32 GetSourceCrc(FStringView SourceText)
+	{
+		return FCrc::MemCrc32(SourceText.GetData(), SourceText.Len() * sizeof(TCHAR));
+	}
+}
+
+// ================================================================================================
+
+FStringView FK2PostItBlockView::GetText() const
+{
+	return FStringView(Document.Buffer).Mid(Record.TextStart, Record.TextLen);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+TConstArrayView<FK2PostItSpanRecord> FK2PostItBlockView::GetSpans() const
+{
+	return TConstArrayView<FK2PostItSpanRecord>(Document.Spans).Slice(Record.FirstSpan, Record.NumSpans);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FStringView FK2PostItBlockView::GetSpanText(const FK2PostItSpanRecord& Span) const
+{
+	return FStringView(Document.Buffer).Mid(Span.ContentStart, Span.ContentLen);
+}
+
+// ================================================================================================
+
+void FK2PostItDocument::Reset()
+{
+	Buffer.Reset();
+	Blocks.Reset();
+	Spans.Reset();
+	ParserVersion = 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FK2PostItDocument::AddBlock(EK2PostItBlockType Type, FStringView Markup, uint8 IndentLevel)
+{
+	FK2PostItBlockRecord& Record = Blocks.AddDefaulted_GetRef();
+	Record.Type = Type;
+	Record.IndentLevel = IndentLevel;
+	Record.TextStart = Buffer.Len();
+	Record.TextLen = Markup.Len();
+
+	Buffer.Append(Markup.GetData(), Markup.Len());
+
+	ScanSpans(Record);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FK2PostItDocument::Shrink()
+{
+	Buffer.Shrink();
+	Blocks.Shrink();
+	Spans.Shrink();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+TSharedRef<const FK2PostItDocument> FK2PostItDocument::GetEmpty()
+{
+	static const TSharedRef<const FK2PostItDocument> Empty = MakeShared<FK2PostItDocument>();
+	return Empty;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FK2PostItDocument::ScanSpans(FK2PostItBlockRecord& Record)
+{
+	Record.FirstSpan = Spans.Num();
+	Record.NumSpans = 0;
+
+	// Code blocks and separators never contain inline markup
+	if (Record.Type != EK2PostItBlockType::Text && Record.Type != EK2PostItBlockType::Bullet)
+	{
+		return;
+	}
+
+	struct FTagName
+	{
+		const TCHAR* Prefix;
+		EK2PostItSpanType Type;
+	};
+
+	// These must match the tags emitted by the inline parsers in FK2PostItAsyncParser
+	static const FTagName TagNames[]
+	{
+		{ TEXT("K2PostIt.Header1>"), EK2PostItSpanType::Header1 },
+		{ TEXT("K2PostIt.Header2>"), EK2PostItSpanType::Header2 },
+		{ TEXT("K2PostIt.Header3>"), EK2PostItSpanType::Header3 },
+		{ TEXT("K2PostIt.Code>"), EK2PostItSpanType::Code },
+		{ TEXT("K2PostIt.BoldItalic>"), EK2PostItSpanType::BoldItalic },
+		{ TEXT("K2PostIt.Bold>"), EK2PostItSpanType::Bold },
+		{ TEXT("K2PostIt.Italic>"), EK2PostItSpanType::Italic },
+		{ TEXT("K2PostIt.Underline>"), EK2PostItSpanType::Underline },
+		{ TEXT("a "), EK2PostItSpanType::Link },
+	};
+
+	const FStringView Text = FStringView(Buffer).Mid(Record.TextStart, Record.TextLen);
+
+	auto FindNextTag = [&Text] (int32 From)
+	{
+		return From < Text.Len() ? Text.Find(TEXT("<"), From) : INDEX_NONE;
+	};
+
+	int32 Index = FindNextTag(0);
+
+	while (Index != INDEX_NONE)
+	{
+		const FStringView Tag = Text.RightChop(Index + 1);
+
+		const FTagName* Match = nullptr;
+
+		for (const FTagName& TagName : TagNames)
+		{
+			if (Tag.StartsWith(TagName.Prefix, ESearchCase::CaseSensitive))
+			{
+				Match = &TagName;
+				break;
+			}
+		}
+
+		const int32 TagEnd = Match ? Text.Find(TEXT(">"), Index) : INDEX_NONE;
+		const int32 CloseTag = TagEnd != INDEX_NONE ? Text.Find(TEXT("</>"), TagEnd + 1) : INDEX_NONE;
+
+		if (CloseTag == INDEX_NONE)
+		{
+			// Not one of ours (a literal '<' in the comment), keep looking
+			Index = FindNextTag(Index + 1);
+			continue;
+		}
+
+		FK2PostItSpanRecord& Span = Spans.AddDefaulted_GetRef();
+		Span.Type = Match->Type;
+		Span.ContentStart = Record.TextStart + TagEnd + 1;
+		Span.ContentLen = CloseTag - TagEnd - 1;
+
+		++Record.NumSpans;
+
+		Index = FindNextTag(CloseTag + 3);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+SIZE_T FK2PostItDocument::GetAllocatedSize() const
+{
+	return Buffer.GetAllocatedSize() + Blocks.GetAllocatedSize() + Spans.GetAllocatedSize();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+uint64 FK2PostItDocument::GetContentHash() const
+{
+	// Only needs to spread documents out, FK2PostItDocumentPool compares documents that hash equally
+	return CityHash64WithSeed(reinterpret_cast<const char*>(*Buffer), Buffer.Len() * sizeof(TCHAR), Blocks.Num());
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FK2PostItDocument::operator==(const FK2PostItDocument& Other) const
+{
+	return Blocks == Other.Blocks && Spans == Other.Spans && Buffer.Equals(Other.Buffer, ESearchCase::CaseSensitive);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FK2PostItDocument FK2PostItDocument::FromBlocks(const TArray<TInstancedStruct<FK2PostIt_BaseBlock>>& InBlocks)
+{
+	FK2PostItDocument Document;
+	Document.Blocks.Reserve(InBlocks.Num());
+
+	for (const TInstancedStruct<FK2PostIt_BaseBlock>& Block : InBlocks)
+	{
+		const UScriptStruct* BlockType = Block.GetScriptStruct();
+
+		if (BlockType == FK2PostIt_SeparatorBlock::StaticStruct())
+		{
+			Document.AddBlock(EK2PostItBlockType::Separator, FStringView());
+		}
+		else if (BlockType == FK2PostIt_CodeBlock::StaticStruct())
+		{
+			Document.AddBlock(EK2PostItBlockType::Code, Block.Get<FK2PostIt_CodeBlock>().GetText());
+		}
+		else if (BlockType == FK2PostIt_BulletBlock::StaticStruct())
+		{
+			const FK2PostIt_BulletBlock& Bullet = Block.Get<FK2PostIt_BulletBlock>();
+			Document.AddBlock(EK2PostItBlockType::Bullet, Bullet.GetText(), Bullet.GetIndentLevel());
+		}
+		else if (BlockType == FK2PostIt_TextBlock::StaticStruct())
+		{
+			Document.AddBlock(EK2PostItBlockType::Text, Block.Get<FK2PostIt_TextBlock>().GetText());
+		}
+	}
+
+	Document.Shrink();
+
+	return Document;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+TArray<TInstancedStruct<FK2PostIt_BaseBlock>> FK2PostItDocument::ToBlocks() const
+{
+	TArray<TInstancedStruct<FK2PostIt_BaseBlock>> OutBlocks;
+	OutBlocks.Reserve(Blocks.Num());
+
+	for (const FK2PostItBlockView Block : *this)
+	{
+		const FString Text(Block.GetText());
+
+		switch (Block.GetType())
+		{
+			case EK2PostItBlockType::Separator:
+			{
+				OutBlocks.Add(TInstancedStruct<FK2PostIt_BaseBlock>::Make<FK2PostIt_SeparatorBlock>());
+				break;
+			}
+			case EK2PostItBlockType::Code:
+			{
+				OutBlocks.Add(TInstancedStruct<FK2PostIt_BaseBlock>::Make<FK2PostIt_CodeBlock>(Text));
+				break;
+			}
+			case EK2PostItBlockType::Bullet:
+			{
+				OutBlocks.Add(TInstancedStruct<FK2PostIt_BaseBlock>::Make<FK2PostIt_BulletBlock>(Block.GetIndentLevel(), Text));
+				break;
+			}
+			case EK2PostItBlockType::Text:
+			{
+				OutBlocks.Add(TInstancedStruct<FK2PostIt_BaseBlock>::Make<FK2PostIt_TextBlock>(Text));
+				break;
+			}
+		}
+	}
+
+	return OutBlocks;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FK2PostItDocument::Save(FArchive& Ar, FStringView SourceText) const
+{
+	using namespace K2PostIt::Document;
+
+	check(Ar.IsSaving());
+
+	// The source length and CRC let us detect comment text that changed underneath the stored ranges (e.g. a merge that only kept one side)
+	uint32 SourceCrc = GetSourceCrc(SourceText);
+	int32 SourceLen = SourceText.Len();
+	int32 StoredParserVersion = ParserVersion;
+	int32 NumBlocks = Blocks.Num();
+
+	Ar << SourceCrc;
+	SerializePacked(Ar, SourceLen);
+	SerializePacked(Ar, StoredParserVersion);
+	SerializePacked(Ar, NumBlocks);
+
+	// Blocks come out of the parser in source order, so searching on from the end of the previous match keeps this linear for typical comments
+	int32 SearchFrom = 0;
+
+	for (const FK2PostItBlockRecord& Record : Blocks)
+	{
+		const FStringView Text = FStringView(Buffer).Mid(Record.TextStart, Record.TextLen);
+
+		EStoredText Storage = EStoredText::Utf8;
+		int32 RangeStart = INDEX_NONE;
+
+		if (Text.IsEmpty())
+		{
+			Storage = EStoredText::Empty;
+		}
+		else if (Record.NumSpans == 0)
+		{
+			RangeStart = SourceText.Find(Text, SearchFrom, ESearchCase::CaseSensitive);
+
+			if (RangeStart == INDEX_NONE && SearchFrom > 0)
+			{
+				RangeStart = SourceText.Find(Text, 0, ESearchCase::CaseSensitive);
+			}
+
+			if (RangeStart != INDEX_NONE)
+			{
+				Storage = EStoredText::SourceRange;
+				SearchFrom = RangeStart + Text.Len();
+			}
+		}
+
+		uint8 Header = static_cast<uint8>(Record.Type) | (static_cast<uint8>(Storage) << 4);
+		Ar << Header;
+
+		if (Record.Type == EK2PostItBlockType::Bullet)
+		{
+			uint8 IndentLevel = Record.IndentLevel;
+			Ar << IndentLevel;
+		}
+
+		if (Storage == EStoredText::SourceRange)
+		{
+			int32 RangeLen = Text.Len();
+			SerializePacked(Ar, RangeStart);
+			SerializePacked(Ar, RangeLen);
+		}
+		else if (Storage == EStoredText::Utf8)
+		{
+			FTCHARToUTF8 Utf8(Text.GetData(), Text.Len());
+			int32 ByteLen = Utf8.Length();
+			SerializePacked(Ar, ByteLen);
+			Ar.Serialize(const_cast<ANSICHAR*>(reinterpret_cast<const ANSICHAR*>(Utf8.Get())), ByteLen);
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FK2PostItDocument::Load(FArchive& Ar, FStringView SourceText, int32 DataVersion)
+{
+	using namespace K2PostIt::Document;
+
+	check(Ar.IsLoading());
+
+	uint32 SourceCrc = 0;
+	int32 SourceLen = 0;
+	int32 StoredParserVersion = 0;
+	int32 NumBlocks = 0;
+
+	Ar << SourceCrc;
+	SerializePacked(Ar, SourceLen);
+
+	if (DataVersion >= FK2PostItCustomVersion::ParserVersionStamp)
+	{
+		SerializePacked(Ar, StoredParserVersion);
+	}
+
+	SerializePacked(Ar, NumBlocks);
+
+	Reset();
+
+	ParserVersion = StoredParserVersion;
+
+	bool bMatchesSource = SourceLen == SourceText.Len() && SourceCrc == GetSourceCrc(SourceText);
+
+	TArray<ANSICHAR> Utf8;
+
+	for (int32 i = 0; i < NumBlocks && !Ar.IsError(); ++i)
+	{
+		uint8 Header = 0;
+		uint8 IndentLevel = 0;
+		Ar << Header;
+
+		const EK2PostItBlockType Type = static_cast<EK2PostItBlockType>(Header & 0x0F);
+		const EStoredText Storage = static_cast<EStoredText>(Header >> 4);
+
+		if (static_cast<int32>(Type) >= K2PostIt::NumBlockTypes)
+		{
+			Ar.SetError();
+			break;
+		}
+
+		if (Type == EK2PostItBlockType::Bullet)
+		{
+			Ar << IndentLevel;
+		}
+
+		switch (Storage)
+		{
+			case EStoredText::Empty:
+			{
+				AddBlock(Type, FStringView(), IndentLevel);
+				break;
+			}
+			case EStoredText::SourceRange:
+			{
+				int32 RangeStart = 0;
+				int32 RangeLen = 0;
+				SerializePacked(Ar, RangeStart);
+				SerializePacked(Ar, RangeLen);
+
+				bMatchesSource &= RangeStart >= 0 && RangeLen >= 0 && RangeStart + RangeLen <= SourceText.Len();
+
+				if (bMatchesSource)
+				{
+					AddBlock(Type, SourceText.Mid(RangeStart, RangeLen), IndentLevel);
+				}
+				break;
+			}
+			case EStoredText::Utf8:
+			{
+				int32 ByteLen = 0;
+				SerializePacked(Ar, ByteLen);
+
+				if (ByteLen < 0 || (Ar.TotalSize() >= 0 && ByteLen > Ar.TotalSize() - Ar.Tell()))
+				{
+					Ar.SetError();
+					break;
+				}
+
+				Utf8.SetNumUninitialized(ByteLen, EAllowShrinking::No);
+				Ar.Serialize(Utf8.GetData(), ByteLen);
+
+				FUTF8ToTCHAR Text(Utf8.GetData(), ByteLen);
+				AddBlock(Type, FStringView(Text.Get(), Text.Length()), IndentLevel);
+				break;
+			}
+			default:
+			{
+				Ar.SetError();
+				break;
+			}
+		}
+	}
+
+	if (!bMatchesSource || Ar.IsError())
+	{
+		Reset();
+		return false;
+	}
+
+	Shrink();
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,126 @@
+// Unlicensed. This file is public domain.
+
+#include "K2PostIt/K2PostItDocumentPool.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+FK2PostItDocumentRef FK2PostItDocumentPool::Intern(FK2PostItDocumentRef Document)
+{
+	if (Document->IsEmpty())
+	{
+		return FK2PostItDocument::GetEmpty();
+	}
+
+	FK2PostItDocumentPool& Pool = Get();
+	const uint64 Hash = Document->GetContentHash();
+
+	FScopeLock ScopeLock(&Pool.Lock);
+
+	for (auto It = Pool.Entries.CreateKeyIterator(Hash); It; ++It)
+	{
+		FK2PostItDocumentPtr Pooled = It.Value().Pin();
+
+		if (!Pooled.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+		// Equality leaves the parser version out, but a node holding a document from an older parser would reparse it on every load
+		else if (Pooled == Document || (Pooled->GetParserVersion() == Document->GetParserVersion() && *Pooled == *Document))
+		{
+			return Pooled.ToSharedRef();
+		}
+	}
+
+	Pool.Entries.Add(Hash, Document);
+
+	if (++Pool.NumAddsSincePrune > Pool.Entries.Num() / 2)
+	{
+		Pool.Prune();
+	}
+
+	return Document;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FK2PostItDocumentPool::FStats FK2PostItDocumentPool::GetStats()
+{
+	FK2PostItDocumentPool& Pool = Get();
+
+	FScopeLock ScopeLock(&Pool.Lock);
+
+	Pool.Prune();
+
+	FStats Stats;
+
+	for (const TPair<uint64, TWeakPtr<const FK2PostItDocument>>& Entry : Pool.Entries)
+	{
+		if (FK2PostItDocumentPtr Pooled = Entry.Value.Pin())
+		{
+			// Less the reference we just took
+			const int32 NumReferences = Pooled.GetSharedReferenceCount() - 1;
+			const SIZE_T Size = sizeof(FK2PostItDocument) + Pooled->GetAllocatedSize();
+
+			Stats.NumDocuments++;
+			Stats.NumReferences += NumReferences;
+			Stats.AllocatedBytes += Size;
+			Stats.SavedBytes += Size * FMath::Max(NumReferences - 1, 0);
+		}
+	}
+
+	return Stats;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FK2PostItDocumentPool& FK2PostItDocumentPool::Get()
+{
+	static FK2PostItDocumentPool Instance;
+	return Instance;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FK2PostItDocumentPool::Prune()
+{
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	Entries.Compact();
+	NumAddsSincePrune = 0;
+}
+
+// ================================================================================================
+
+namespace K2PostIt::DocumentPool
+{
+	static void LogStats()
+	{
+		const FK2PostItDocumentPool::FStats Stats = FK2PostItDocumentPool::GetStats();
+
+		UE_LOG(LogTemp, Display, TEXT("K2PostIt document pool: %d documents, %d references, %llu B allocated, %llu B saved by sharing"),
+			Stats.NumDocuments,
+			Stats.NumReferences,
+			static_cast<uint64>(Stats.AllocatedBytes),
+			static_cast<uint64>(Stats.SavedBytes));
+	}
+
+	static FAutoConsoleCommand LogStatsCommand(
+		TEXT("K2PostIt.DocumentPoolStats"),
+		TEXT("Logs how many parsed comment documents are shared between nodes and the memory that saves."),
+		FConsoleCommandDelegate::CreateStatic(&LogStats));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#undef LOCTEXT_NAMESPACE
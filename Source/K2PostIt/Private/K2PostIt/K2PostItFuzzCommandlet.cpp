@@ -0,0 +1,309 @@
+// Unlicensed. This file is public domain.
+
+#include "K2PostIt/K2PostItFuzzCommandlet.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Interfaces/IPluginManager.h"
+#include "K2PostIt/K2PostItAsyncParser.h"
+#include "K2PostIt/K2PostItCustomVersion.h"
+#include "K2PostIt/K2PostItDocument.h"
+#include "K2PostIt/K2PostItProjectSettings.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+namespace K2PostIt::Fuzz
+{
+	/** Markdown fragments spliced in by the mutator, so mutations reach the parser's rules rather than only producing plain text */
+	static const TCHAR* Tokens[]
+	{
+		TEXT("*"), TEXT("**"), TEXT("***"), TEXT("_"), TEXT("__"), TEXT("`"), TEXT("```"), TEXT("```\n"),
+		TEXT("- "), TEXT("  - "), TEXT("    - "), TEXT("# "), TEXT("## "), TEXT("### "), TEXT("---\n"),
+		TEXT("["), TEXT("]("), TEXT(")"), TEXT("](https://x)"), TEXT("\n"), TEXT("\n\n"), TEXT("\\"), TEXT("<"), TEXT(">"), TEXT("  "), TEXT("\t"),
+	};
+
+	static FString GetOutputDir()
+	{
+		return FPaths::ProjectSavedDir() / TEXT("K2PostIt") / TEXT("Fuzz");
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	/** Parses Text and checks the document comes back unchanged from a save and load. Returns what went wrong, or an empty string. */
+	static FString CheckInput(const FString& Text, double& OutElapsed)
+	{
+		FK2PostItDocument Document;
+
+		const double Start = FPlatformTime::Seconds();
+		FK2PostItAsyncParser::PeasantTextToRichText(Text, Document);
+		OutElapsed = FPlatformTime::Seconds() - Start;
+
+		TArray<uint8> Bytes;
+		FMemoryWriter Writer(Bytes);
+		Document.Save(Writer, Text);
+
+		FMemoryReader Reader(Bytes);
+		FK2PostItDocument Loaded;
+
+		if (!Loaded.Load(Reader, Text, FK2PostItCustomVersion::LatestVersion) || Reader.IsError())
+		{
+			return TEXT("the saved document did not load");
+		}
+
+		if (Loaded != Document)
+		{
+			return TEXT("the saved document loaded differently");
+		}
+
+		return FString();
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	int32 TestOneInput(const uint8* Data, SIZE_T Size)
+	{
+		const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Data), static_cast<int32>(Size));
+		const FString Text(Converted.Length(), Converted.Get());
+
+		double Elapsed = 0.0;
+		const FString Problem = CheckInput(Text, Elapsed);
+
+		checkf(Problem.IsEmpty(), TEXT("K2PostIt fuzz: %s"), *Problem);
+
+		return 0;
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	static TCHAR RandomChar(FRandomStream& Random)
+	{
+		// Mostly ASCII, sometimes anything in the BMP but surrogates, which would not survive being saved as UTF-8
+		if (Random.RandHelper(4) > 0)
+		{
+			return static_cast<TCHAR>(Random.RandRange(0x20, 0x7E));
+		}
+
+		const int32 CodePoint = Random.RandRange(1, 0xFFFF - 0x800);
+		return static_cast<TCHAR>(CodePoint < 0xD800 ? CodePoint : CodePoint + 0x800);
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	static void Mutate(FRandomStream& Random, const TArray<FString>& Corpus, int32 MaxLength, FString& Text)
+	{
+		const int32 NumMutations = 1 + Random.RandHelper(8);
+
+		for (int32 i = 0; i < NumMutations; ++i)
+		{
+			const int32 Pos = Random.RandHelper(Text.Len() + 1);
+			const int32 Remaining = Text.Len() - Pos;
+
+			switch (Random.RandHelper(5))
+			{
+				case 0:
+					Text.InsertAt(Pos, Tokens[Random.RandHelper(UE_ARRAY_COUNT(Tokens))]);
+					break;
+
+				case 1:
+					if (Remaining > 0)
+					{
+						Text.RemoveAt(Pos, 1 + Random.RandHelper(FMath::Min(Remaining, 16)));
+					}
+					break;
+
+				case 2:
+					if (!Text.IsEmpty())
+					{
+						const int32 Start = Random.RandHelper(Text.Len());
+						Text.InsertAt(Pos, Text.Mid(Start, 1 + Random.RandHelper(64)));
+					}
+					break;
+
+				case 3:
+					if (Remaining > 0)
+					{
+						Text[Pos] = RandomChar(Random);
+					}
+					else
+					{
+						Text.AppendChar(RandomChar(Random));
+					}
+					break;
+
+				case 4:
+				default:
+				{
+					const FString& Other = Corpus[Random.RandHelper(Corpus.Num())];
+					const int32 Start = Random.RandHelper(Other.Len());
+					Text.InsertAt(Pos, Other.Mid(Start, 1 + Random.RandHelper(256)));
+					break;
+				}
+			}
+		}
+
+		Text.LeftInline(MaxLength);
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	static void LoadSeeds(const FString& Directory, TArray<FString>& Corpus)
+	{
+		TArray<FString> Files;
+		IFileManager::Get().FindFiles(Files, *(Directory / TEXT("*.md")), true, false);
+
+		for (const FString& File : Files)
+		{
+			FString Seed;
+
+			if (FFileHelper::LoadFileToString(Seed, *(Directory / File)))
+			{
+				Corpus.Add(MoveTemp(Seed));
+			}
+		}
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	static void SaveFinding(const TCHAR* Category, const FString& Input)
+	{
+		const FString FilePath = GetOutputDir() / Category / FString::Printf(TEXT("%08x.md"), GetTypeHash(Input));
+
+		FFileHelper::SaveStringToFile(Input, *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+
+		UE_LOG(LogTemp, Warning, TEXT("K2PostIt fuzz: saved %s"), *FilePath);
+	}
+}
+
+// ================================================================================================
+
+UK2PostItFuzzCommandlet::UK2PostItFuzzCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 UK2PostItFuzzCommandlet::Main(const FString& Params)
+{
+	using namespace K2PostIt::Fuzz;
+
+	int32 Iterations = 10000;
+	int32 Seed = static_cast<int32>(FPlatformTime::Cycles());
+	int32 MaxLength = 16 * 1024;
+	FString InputFile;
+
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("MaxLength="), MaxLength);
+	FParse::Value(*Params, TEXT("Input="), InputFile);
+
+	int32 NumFailures = 0;
+	int32 NumSlow = 0;
+
+	// Written before every parse and deleted after the run, so if it is still there the previous run died on it
+	const FString InFlightPath = GetOutputDir() / TEXT("InFlight.md");
+	FString CrashedInput;
+
+	if (FFileHelper::LoadFileToString(CrashedInput, *InFlightPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("K2PostIt fuzz: the previous run did not finish, keeping the input it was parsing"));
+
+		SaveFinding(TEXT("Crashes"), CrashedInput);
+		IFileManager::Get().Delete(*InFlightPath);
+		++NumFailures;
+	}
+
+	if (!InputFile.IsEmpty())
+	{
+		FString Input;
+
+		if (!FFileHelper::LoadFileToString(Input, *InputFile))
+		{
+			UE_LOG(LogTemp, Error, TEXT("K2PostIt fuzz: could not read %s"), *InputFile);
+			return 1;
+		}
+
+		double Elapsed = 0.0;
+		const FString Problem = CheckInput(Input, Elapsed);
+
+		UE_LOG(LogTemp, Display, TEXT("K2PostIt fuzz: %s parsed in %.3f ms, %s"), *InputFile, Elapsed * 1000.0, Problem.IsEmpty() ? TEXT("ok") : *Problem);
+
+		return Problem.IsEmpty() ? 0 : 1;
+	}
+
+	TArray<FString> Corpus;
+
+	if (TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("K2PostIt")))
+	{
+		LoadSeeds(Plugin->GetBaseDir() / TEXT("Resources") / TEXT("FuzzCorpus"), Corpus);
+
+		FString Readme;
+
+		if (FFileHelper::LoadFileToString(Readme, *(Plugin->GetBaseDir() / TEXT("README.md"))))
+		{
+			Corpus.Add(MoveTemp(Readme));
+		}
+	}
+
+	// Earlier findings are kept as seeds so they are checked again on every run
+	LoadSeeds(GetOutputDir() / TEXT("Crashes"), Corpus);
+	LoadSeeds(GetOutputDir() / TEXT("Failures"), Corpus);
+	LoadSeeds(GetOutputDir() / TEXT("Slow"), Corpus);
+
+	Corpus.RemoveAll([] (const FString& Input) { return Input.IsEmpty(); });
+
+	if (Corpus.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error, TEXT("K2PostIt fuzz: no seeds found"));
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("K2PostIt fuzz: %d iterations from %d seeds, -Seed=%d"), Iterations, Corpus.Num(), Seed);
+
+	FRandomStream Random(Seed);
+
+	for (int32 i = 0; i < Iterations; ++i)
+	{
+		FString Input = Corpus[Random.RandHelper(Corpus.Num())];
+		Mutate(Random, Corpus, MaxLength, Input);
+
+		FFileHelper::SaveStringToFile(Input, *InFlightPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+
+		double Elapsed = 0.0;
+		const FString Problem = CheckInput(Input, Elapsed);
+
+		if (!Problem.IsEmpty())
+		{
+			UE_LOG(LogTemp, Error, TEXT("K2PostIt fuzz: %s"), *Problem);
+
+			SaveFinding(TEXT("Failures"), Input);
+			++NumFailures;
+		}
+		else if (Elapsed > UK2PostItProjectSettings::GetSlowParseThreshold(Input.Len()))
+		{
+			SaveFinding(TEXT("Slow"), Input);
+			++NumSlow;
+		}
+	}
+
+	IFileManager::Get().Delete(*InFlightPath);
+
+	UE_LOG(LogTemp, Display, TEXT("K2PostIt fuzz: %d iterations, %d failed, %d slow"), Iterations, NumFailures, NumSlow);
+
+	return NumFailures > 0 ? 1 : 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,169 @@
+// Unlicensed. This file is public domain.
+
+#include "K2PostIt/K2PostItGraphViewTracker.h"
+
+#include "K2PostIt/Widgets/SGraphNode_K2PostIt.h"
+#include "Layout/Geometry.h"
+#include "SGraphPanel.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+void FK2PostItGraphViewTracker::Register(const TSharedRef<SGraphPanel>& Panel, const TSharedRef<SGraphNode_K2PostIt>& Node)
+{
+	FK2PostItGraphViewTracker& Tracker = Get();
+
+	FPanelView* View = Tracker.FindPanelView(&Panel.Get());
+
+	if (View == nullptr)
+	{
+		View = &Tracker.PanelViews.AddDefaulted_GetRef();
+		View->Panel = Panel;
+	}
+
+	View->Nodes.Add(Node);
+	View->DirtyNodes.Add(Node);
+
+	if (!Tracker.TickerHandle.IsValid())
+	{
+		Tracker.TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(&Tracker, &FK2PostItGraphViewTracker::Tick));
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FK2PostItGraphViewTracker::Refresh(const TSharedRef<SGraphNode_K2PostIt>& Node)
+{
+	const TSharedPtr<SGraphPanel> Panel = Node->GetOwnerPanel();
+
+	if (!Panel.IsValid())
+	{
+		return;
+	}
+
+	if (FPanelView* View = Get().FindPanelView(Panel.Get()))
+	{
+		View->DirtyNodes.Add(Node);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FK2PostItGraphViewTracker& FK2PostItGraphViewTracker::Get()
+{
+	static FK2PostItGraphViewTracker Instance;
+	return Instance;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FK2PostItGraphViewTracker::FPanelView* FK2PostItGraphViewTracker::FindPanelView(const SGraphPanel* Panel)
+{
+	return PanelViews.FindByPredicate([Panel] (const FPanelView& View)
+	{
+		return View.Panel.Pin().Get() == Panel;
+	});
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FK2PostItGraphViewTracker::Tick(float DeltaTime)
+{
+	for (int32 i = PanelViews.Num() - 1; i >= 0; --i)
+	{
+		const TSharedPtr<SGraphPanel> Panel = PanelViews[i].Panel.Pin();
+
+		if (!Panel.IsValid())
+		{
+			PanelViews.RemoveAtSwap(i);
+			continue;
+		}
+
+		FPanelView& View = PanelViews[i];
+
+		const float ZoomAmount = Panel->GetZoomAmount();
+		const FVector2D ViewOffset(Panel->GetViewOffset());
+		const FVector2D ViewSize = FVector2D(Panel->GetTickSpaceGeometry().GetLocalSize()) / ZoomAmount;
+
+		const EGraphRenderingLOD::Type LOD = Panel->GetCurrentLOD();
+		const FSlateRect ViewRect(ViewOffset, ViewOffset + ViewSize);
+
+		const bool bViewChanged = LOD != View.LOD || ViewRect != View.ViewRect;
+
+		// Compared rather than copied every frame, this is as long as the selection and not as the graph
+		const FGraphPanelSelectionSet& SelectedNodes = Panel->SelectionManager.SelectedNodes;
+
+		bool bSelectionChanged = SelectedNodes.Num() != View.SelectedNodes.Num();
+
+		for (auto It = SelectedNodes.CreateConstIterator(); It && !bSelectionChanged; ++It)
+		{
+			bSelectionChanged = !View.SelectedNodes.Contains(*It);
+		}
+
+		View.LOD = LOD;
+		View.ViewRect = ViewRect;
+
+		if (bSelectionChanged)
+		{
+			View.SelectedNodes = SelectedNodes;
+		}
+
+		// The nodes may ask for another refresh while being pushed to, those wait for the next tick
+		const TSet<TWeakPtr<SGraphNode_K2PostIt>> DirtyNodes = MoveTemp(View.DirtyNodes);
+		View.DirtyNodes.Reset();
+
+		if (bViewChanged || bSelectionChanged)
+		{
+			View.Nodes.RemoveAllSwap([] (const TWeakPtr<SGraphNode_K2PostIt>& Node) { return !Node.IsValid(); });
+
+			// Copied, a node can be added to this panel while another one is being pushed to
+			const TArray<TWeakPtr<SGraphNode_K2PostIt>> Nodes = View.Nodes;
+
+			for (const TWeakPtr<SGraphNode_K2PostIt>& WeakNode : Nodes)
+			{
+				const TSharedPtr<SGraphNode_K2PostIt> Node = WeakNode.Pin();
+
+				if (!Node.IsValid())
+				{
+					continue;
+				}
+
+				const bool bDirty = DirtyNodes.Contains(WeakNode);
+
+				if (bSelectionChanged || bDirty)
+				{
+					Node->OnSelectionChanged(SelectedNodes.Contains(Node->GetNodeObj()));
+				}
+
+				if (bViewChanged || bDirty)
+				{
+					Node->OnGraphViewChanged(ViewRect);
+				}
+			}
+		}
+		else
+		{
+			for (const TWeakPtr<SGraphNode_K2PostIt>& WeakNode : DirtyNodes)
+			{
+				if (const TSharedPtr<SGraphNode_K2PostIt> Node = WeakNode.Pin())
+				{
+					Node->OnSelectionChanged(View.SelectedNodes.Contains(Node->GetNodeObj()));
+					Node->OnGraphViewChanged(ViewRect);
+				}
+			}
+		}
+	}
+
+	if (PanelViews.IsEmpty())
+	{
+		TickerHandle.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#undef LOCTEXT_NAMESPACE
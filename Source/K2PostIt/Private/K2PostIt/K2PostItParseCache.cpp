@@ -0,0 +1,83 @@
+// Unlicensed. This file is public domain.
+
+#include "K2PostIt/K2PostItParseCache.h"
+
+#include "K2PostIt/Globals/K2PostItConstants.h"
+#include "Misc/ScopeLock.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+FK2PostItDocumentPtr FK2PostItParseCache::Find(FStringView SourceText)
+{
+	FK2PostItParseCache& Cache = Get();
+	const FBlake3Hash Hash = HashSource(SourceText);
+
+	FScopeLock ScopeLock(&Cache.Lock);
+
+	const FK2PostItDocumentPtr* Cached = Cache.Entries.FindAndTouch(Hash);
+
+	return Cached ? *Cached : nullptr;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FK2PostItDocumentRef FK2PostItParseCache::Add(FStringView SourceText, FK2PostItDocumentRef Document)
+{
+	FK2PostItParseCache& Cache = Get();
+	const FBlake3Hash Hash = HashSource(SourceText);
+
+	FScopeLock ScopeLock(&Cache.Lock);
+
+	if (const FK2PostItDocumentPtr* Cached = Cache.Entries.FindAndTouch(Hash))
+	{
+		// Equality leaves the parser version out, a newer document replaces an equal one so its stamp is not lost
+		if (*Cached == Document || ((*Cached)->GetParserVersion() == Document->GetParserVersion() && **Cached == *Document))
+		{
+			return Cached->ToSharedRef();
+		}
+	}
+
+	// Replaces the entry for the same source, or evicts the least recently used one when full
+	Cache.Entries.Add(Hash, Document);
+
+	return Document;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FK2PostItParseCache::Empty()
+{
+	FK2PostItParseCache& Cache = Get();
+
+	FScopeLock ScopeLock(&Cache.Lock);
+
+	Cache.Entries.Empty(K2PostIt::Constants::ParseCacheMaxEntries);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FK2PostItParseCache::FK2PostItParseCache()
+	: Entries(K2PostIt::Constants::ParseCacheMaxEntries)
+{
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FK2PostItParseCache& FK2PostItParseCache::Get()
+{
+	static FK2PostItParseCache Instance;
+	return Instance;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FBlake3Hash FK2PostItParseCache::HashSource(FStringView SourceText)
+{
+	return FBlake3::HashBuffer(SourceText.GetData(), SourceText.Len() * sizeof(TCHAR));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#undef LOCTEXT_NAMESPACE
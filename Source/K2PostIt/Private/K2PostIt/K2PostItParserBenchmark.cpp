@@ -0,0 +1,332 @@
+// Unlicensed. This file is public domain.
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "HAL/PlatformTime.h"
+#include "K2PostIt/K2PostItAsyncParser.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+/**
+ * Headless throughput benchmark for the comment parser. Run it as the K2PostIt.Parser.Benchmark automation test, from the editor console, or unattended with:
+ *
+ *   UnrealEditor <Project> -nullrhi -unattended -ExecCmds="Automation RunTests K2PostIt.Parser.Benchmark; Quit"
+ *   UnrealEditor <Project> -nullrhi -unattended -ExecCmds="K2PostIt.BenchmarkParser, Quit"
+ *
+ * Pass -llm to also record the memory a parse holds on to. Results are written as JSON to Saved/K2PostIt/ParserBenchmark.json and echoed to the log.
+ */
+namespace K2PostIt::Benchmark
+{
+	using FCorpusGenerator = TFunction<void(FRandomStream& Random, FString& Out)>;
+
+	struct FCorpus
+	{
+		FString Name;
+		FCorpusGenerator Generator;
+	};
+
+	// --------------------------------------------------------------------------------------------
+
+	static const TCHAR* Words[] { TEXT("graph"), TEXT("node"), TEXT("comment"), TEXT("pin"), TEXT("actor"), TEXT("the"), TEXT("spawn"), TEXT("delay"), TEXT("and"), TEXT("of"), TEXT("vector"), TEXT("blueprint"), TEXT("latent"), TEXT("is"), TEXT("timer") };
+
+	static void AppendWords(FRandomStream& Random, int32 Count, FString& Out)
+	{
+		for (int32 i = 0; i < Count; ++i)
+		{
+			if (i > 0)
+			{
+				Out += TEXT(' ');
+			}
+
+			Out += Words[Random.RandHelper(UE_ARRAY_COUNT(Words))];
+		}
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	/**
+	 * Bytes a parse of Document still holds when it returns, that is the parsed document, from the K2PostIt/Parser LLM tag. The parse is tagged
+	 * so Insights memory traces attribute it too. Returns -1 unless the editor runs with -llm.
+	 */
+	static int64 MeasureParseMemory(const FString& Document)
+	{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+		if (!FLowLevelMemTracker::IsEnabled())
+		{
+			return -1;
+		}
+
+		const FName Tag(TEXT("K2PostIt/Parser"));
+		FLowLevelMemTracker& Tracker = FLowLevelMemTracker::Get();
+
+		// Tag sizes are gathered from the threads' trackers once per frame, gather them now instead
+		Tracker.UpdateStatsPerFrame();
+		const int64 Before = Tracker.GetTagAmountForTracker(ELLMTracker::Default, Tag, ELLMTagSet::None);
+
+		FK2PostItDocument Parsed;
+
+		{
+			LLM_SCOPE_BYNAME(TEXT("K2PostIt/Parser"));
+			FK2PostItAsyncParser::PeasantTextToRichText(Document, Parsed);
+		}
+
+		Tracker.UpdateStatsPerFrame();
+		return Tracker.GetTagAmountForTracker(ELLMTracker::Default, Tag, ELLMTagSet::None) - Before;
+#else
+		return -1;
+#endif
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	static TArray<FCorpus> MakeCorpora()
+	{
+		return
+		{
+			{
+				TEXT("PlainProse"),
+				[] (FRandomStream& Random, FString& Out)
+				{
+					AppendWords(Random, 40, Out);
+					Out += TEXT(".\n");
+				}
+			},
+			{
+				TEXT("HeavyEmphasis"),
+				[] (FRandomStream& Random, FString& Out)
+				{
+					static const TCHAR* Open[] { TEXT("*"), TEXT("**"), TEXT("***"), TEXT("__"), TEXT("`") };
+
+					for (int32 i = 0; i < 8; ++i)
+					{
+						const TCHAR* Marker = Open[Random.RandHelper(UE_ARRAY_COUNT(Open))];
+						Out += Marker;
+						AppendWords(Random, 3, Out);
+						Out += Marker;
+						Out += TEXT(' ');
+					}
+
+					Out += TEXT("\n");
+				}
+			},
+			{
+				TEXT("DeepBulletLists"),
+				[] (FRandomStream& Random, FString& Out)
+				{
+					// Down to a random depth and back up. The parser renders three levels, deeper items exercise how it handles the rest.
+					const int32 MaxDepth = 4 + Random.RandHelper(13);
+
+					for (int32 Step = 0; Step <= 2 * MaxDepth; ++Step)
+					{
+						const int32 Depth = Step <= MaxDepth ? Step : 2 * MaxDepth - Step;
+
+						Out += FString::ChrN(Depth * 2, TEXT(' '));
+						Out += TEXT("- ");
+						AppendWords(Random, 8, Out);
+						Out += TEXT("\n");
+					}
+				}
+			},
+			{
+				TEXT("ManyCodeFences"),
+				[] (FRandomStream& Random, FString& Out)
+				{
+					Out += TEXT("```\n");
+					AppendWords(Random, 6, Out);
+					Out += TEXT("();\n```\n");
+					AppendWords(Random, 10, Out);
+					Out += TEXT("\n");
+				}
+			},
+			{
+				TEXT("Mixed"),
+				[] (FRandomStream& Random, FString& Out)
+				{
+					Out += TEXT("## ");
+					AppendWords(Random, 3, Out);
+					Out += TEXT("\n");
+					AppendWords(Random, 20, Out);
+					Out += TEXT(" **");
+					AppendWords(Random, 2, Out);
+					Out += TEXT("** [docs](https://dev.epicgames.com)\n- ");
+					AppendWords(Random, 6, Out);
+					Out += TEXT("\n  - `");
+					AppendWords(Random, 2, Out);
+					Out += TEXT("`\n---\n```\nCall();\n```\n");
+				}
+			},
+		};
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	static FString GenerateDocument(const FCorpus& Corpus, int32 TargetLength)
+	{
+		// Fixed seed so that runs are comparable between parser changes
+		FRandomStream Random(0x4B32);
+
+		FString Document;
+		Document.Reserve(TargetLength + 256);
+
+		while (Document.Len() < TargetLength)
+		{
+			Corpus.Generator(Random, Document);
+		}
+
+		return Document;
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	static double Percentile(const TArray<double>& SortedSamples, double Fraction)
+	{
+		if (SortedSamples.IsEmpty())
+		{
+			return 0.0;
+		}
+
+		const int32 Index = FMath::Clamp(FMath::CeilToInt32(Fraction * SortedSamples.Num()) - 1, 0, SortedSamples.Num() - 1);
+		return SortedSamples[Index];
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	static TSharedRef<FJsonObject> RunCase(const FCorpus& Corpus, int32 TargetLength, int32 MaxIterations, double TimeBudget)
+	{
+		const FString Document = GenerateDocument(Corpus, TargetLength);
+		const int32 Bytes = FTCHARToUTF8(*Document, Document.Len()).Length();
+
+		FK2PostItDocument Parsed;
+
+		// Warm up regex pattern compilation and allocator pools
+		FK2PostItAsyncParser::PeasantTextToRichText(Document, Parsed);
+
+		TArray<double> Samples;
+		double TotalTime = 0.0;
+
+		while (Samples.Num() < MaxIterations && (TotalTime < TimeBudget || Samples.Num() < 3))
+		{
+			const double Start = FPlatformTime::Seconds();
+			FK2PostItAsyncParser::PeasantTextToRichText(Document, Parsed);
+			const double Elapsed = FPlatformTime::Seconds() - Start;
+
+			Samples.Add(Elapsed);
+			TotalTime += Elapsed;
+		}
+
+		Samples.Sort();
+
+		const int64 ParseMemory = MeasureParseMemory(Document);
+
+		TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+		Result->SetStringField(TEXT("corpus"), Corpus.Name);
+		Result->SetNumberField(TEXT("bytes"), Bytes);
+		Result->SetNumberField(TEXT("blocks"), Parsed.Num());
+		Result->SetNumberField(TEXT("iterations"), Samples.Num());
+		Result->SetNumberField(TEXT("mb_per_s"), TotalTime > 0.0 ? (Bytes * Samples.Num() / (1024.0 * 1024.0)) / TotalTime : 0.0);
+		Result->SetNumberField(TEXT("p50_ms"), Percentile(Samples, 0.50) * 1000.0);
+		Result->SetNumberField(TEXT("p99_ms"), Percentile(Samples, 0.99) * 1000.0);
+		Result->SetNumberField(TEXT("kb_per_parse"), ParseMemory >= 0 ? ParseMemory / 1024.0 : -1.0);
+
+		return Result;
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	/** Runs every case, logs and saves the results, and returns them */
+	static TArray<TSharedPtr<FJsonValue>> RunAllCases(int32 MaxIterations)
+	{
+		const double TimeBudgetPerCase = 2.0;
+		const int32 Sizes[] { 1024, 10 * 1024, 100 * 1024 };
+
+		TArray<TSharedPtr<FJsonValue>> Results;
+
+		for (const FCorpus& Corpus : MakeCorpora())
+		{
+			for (int32 Size : Sizes)
+			{
+				TSharedRef<FJsonObject> Result = RunCase(Corpus, Size, MaxIterations, TimeBudgetPerCase);
+
+				UE_LOG(LogTemp, Display, TEXT("K2PostIt benchmark: %-16s %7d B  %8.2f MB/s  p50 %8.3f ms  p99 %8.3f ms  %9.1f KB"),
+					*Corpus.Name,
+					(int32)Result->GetNumberField(TEXT("bytes")),
+					Result->GetNumberField(TEXT("mb_per_s")),
+					Result->GetNumberField(TEXT("p50_ms")),
+					Result->GetNumberField(TEXT("p99_ms")),
+					Result->GetNumberField(TEXT("kb_per_parse")));
+
+				Results.Add(MakeShared<FJsonValueObject>(Result));
+			}
+		}
+
+		TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		Root->SetStringField(TEXT("benchmark"), TEXT("K2PostIt.Parser"));
+		Root->SetArrayField(TEXT("results"), Results);
+
+		FString Json;
+		TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&Json);
+		FJsonSerializer::Serialize(Root, Writer);
+
+		const FString FilePath = FPaths::ProjectSavedDir() / TEXT("K2PostIt") / TEXT("ParserBenchmark.json");
+		FFileHelper::SaveStringToFile(Json, *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+
+		UE_LOG(LogTemp, Display, TEXT("K2PostIt benchmark results written to %s"), *FilePath);
+
+		return Results;
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	static void RunParserBenchmark(const TArray<FString>& Args)
+	{
+		RunAllCases(Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 200);
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	static FAutoConsoleCommand BenchmarkParserCommand(
+		TEXT("K2PostIt.BenchmarkParser"),
+		TEXT("Times the K2PostIt comment parser on generated documents and writes JSON results to Saved/K2PostIt/ParserBenchmark.json. Optional argument: max iterations per case."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunParserBenchmark));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FK2PostItParserBenchmarkTest, "K2PostIt.Parser.Benchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FK2PostItParserBenchmarkTest::RunTest(const FString& Parameters)
+{
+	for (const TSharedPtr<FJsonValue>& Value : K2PostIt::Benchmark::RunAllCases(200))
+	{
+		const TSharedPtr<FJsonObject>& Result = Value->AsObject();
+
+		AddInfo(FString::Printf(TEXT("%s %d B: %.2f MB/s, p50 %.3f ms, p99 %.3f ms, %.1f KB per parse"),
+			*Result->GetStringField(TEXT("corpus")),
+			(int32)Result->GetNumberField(TEXT("bytes")),
+			Result->GetNumberField(TEXT("mb_per_s")),
+			Result->GetNumberField(TEXT("p50_ms")),
+			Result->GetNumberField(TEXT("p99_ms")),
+			Result->GetNumberField(TEXT("kb_per_parse"))));
+
+		TestTrue(FString::Printf(TEXT("%s parsed into blocks"), *Result->GetStringField(TEXT("corpus"))), Result->GetNumberField(TEXT("blocks")) > 0);
+	}
+
+	return true;
+}
+
+#endif
+
+// ------------------------------------------------------------------------------------------------
+
+#undef LOCTEXT_NAMESPACE
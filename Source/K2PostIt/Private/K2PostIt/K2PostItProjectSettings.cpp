@@ -64,6 +64,15 @@ const FLinearColor& UK2PostItProjectSettings::GetDefaultCommentColor()
 
 // ------------------------------------------------------------------------------------------------
 
+double UK2PostItProjectSettings::GetSlowParseThreshold(int32 TextLength)
+{
+	const double ThresholdMs = Get().SlowParseBaseThreshold + Get().SlowParseThresholdPerKiloChar * (TextLength / 1000.0);
+
+	return ThresholdMs / 1000.0;
+}
+
+// ------------------------------------------------------------------------------------------------
+
 const UK2PostItProjectSettings& UK2PostItProjectSettings::Get()
 {
 	return *GetDefault<UK2PostItProjectSettings>();
@@ -0,0 +1,89 @@
+// Unlicensed. This file is public domain.
+
+#include "K2PostIt/K2PostItRenderContext.h"
+
+#include "K2PostIt/Globals/K2PostItConstants.h"
+#include "K2PostIt/K2PostItColor.h"
+#include "K2PostIt/Nodes/EdGraphNode_K2PostIt.h"
+#include "K2PostIt/Widgets/SGraphNode_K2PostIt.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+FK2PostItTheme::FK2PostItTheme(const FLinearColor& InCommentColor)
+	: CommentColor(InCommentColor)
+{
+	const float Luminance = CommentColor.GetLuminance();
+
+	FontColor = K2PostItColor::GetNominalFontColor(CommentColor, K2PostItColor::White, K2PostItColor::Noir);
+	DimFontColor = K2PostItColor::GetNominalFontColor(CommentColor, K2PostItColor::DimWhite, K2PostItColor::DeepGray);
+	EmptyTitleColor = K2PostItColor::GetNominalFontColor(CommentColor, K2PostItColor::Gray, K2PostItColor::Gray);
+
+	SeparatorColor = Luminance < K2PostIt::Constants::LuminanceDarkModeThreshold ? K2PostItColor::DimWhite_SemiGlass : K2PostItColor::Noir_SemiGlass;
+
+	CodeBlockFillColor = CommentColor * K2PostIt::Constants::CodeBlock_BorderBackgroundColorMulti;
+	CodeBlockFillColor.A = K2PostItColor::White.A;
+
+	const float CodeBlockBorderLum = Luminance + K2PostIt::Constants::CodeBlock_BorderBrighten;
+	CodeBlockBorderColor = FLinearColor(CodeBlockBorderLum, CodeBlockBorderLum, CodeBlockBorderLum, 1.0f);
+
+	InlineCodeFillColor = CommentColor * 5;
+	InlineCodeFillColor.A = K2PostItColor::White.A;
+
+	const float InlineCodeBorderLum = Luminance * 1.2 + 0.15;
+	InlineCodeBorderColor = FLinearColor(InlineCodeBorderLum, InlineCodeBorderLum, InlineCodeBorderLum, 1.0f);
+
+	PreviewPaneColor = K2PostItColor::Desaturate(CommentColor, 0.1f);
+	PreviewPaneColor = K2PostItColor::Darken(PreviewPaneColor, 0.9f);
+	PreviewPaneColor.A *= 0.8f;
+}
+
+// ================================================================================================
+
+FK2PostItRenderContext::FK2PostItRenderContext(TSharedPtr<SGraphNode_K2PostIt> InOwnerWidget)
+	: OwnerWidget(InOwnerWidget)
+{
+	Update();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FK2PostItRenderContext::Update()
+{
+	bool bChanged = false;
+
+	if (TSharedPtr<SGraphNode_K2PostIt> PinnedOwner = OwnerWidget.Pin())
+	{
+		const float NewWrapAt = PinnedOwner->GetWrapAt();
+
+		if (NewWrapAt != WrapAt)
+		{
+			WrapAt = NewWrapAt;
+			bChanged = true;
+		}
+
+		const UEdGraphNode_K2PostIt* OwnerNode = PinnedOwner->GetNodeObjAsK2PostIt();
+
+		if (IsValid(OwnerNode) && OwnerNode->CommentColor != Theme.CommentColor)
+		{
+			Theme = FK2PostItTheme(OwnerNode->CommentColor);
+			bChanged = true;
+		}
+	}
+
+	return bChanged;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+const FK2PostItRenderContext& FK2PostItBlockBinding::GetContext() const
+{
+	static const FK2PostItRenderContext Unbound(nullptr);
+
+	return Context.IsValid() ? *Context : Unbound;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,150 @@
+// Unlicensed. This file is public domain.
+
+#include "K2PostIt/K2PostItReparseQueue.h"
+
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "K2PostIt/Globals/K2PostItConstants.h"
+#include "K2PostIt/K2PostItAsyncParser.h"
+#include "K2PostIt/Nodes/EdGraphNode_K2PostIt.h"
+#include "Misc/ScopeLock.h"
+#include "Tasks/Task.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+void FK2PostItReparseQueue::Enqueue(UEdGraphNode_K2PostIt* Node, bool bUrgent)
+{
+	FK2PostItReparseQueue& Queue = Get();
+
+	FScopeLock ScopeLock(&Queue.Lock);
+
+	(bUrgent ? Queue.Urgent : Queue.Pending).Add(Node);
+
+	if (!Queue.TickerHandle.IsValid())
+	{
+		Queue.TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(&Queue, &FK2PostItReparseQueue::Tick), K2PostIt::Constants::ReparseInterval);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FK2PostItReparseQueue& FK2PostItReparseQueue::Get()
+{
+	static FK2PostItReparseQueue Instance;
+	return Instance;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FK2PostItReparseQueue::Tick(float DeltaTime)
+{
+	if (bBatchInFlight)
+	{
+		return true;
+	}
+
+	TArray<TWeakObjectPtr<UEdGraphNode_K2PostIt>> Batch;
+	bool bUrgent = false;
+
+	{
+		FScopeLock ScopeLock(&Lock);
+
+		if (!Urgent.IsEmpty())
+		{
+			// Urgent nodes are all taken at once, the user is waiting to see them
+			Batch = MoveTemp(Urgent);
+			bUrgent = true;
+		}
+		else if (!Pending.IsEmpty())
+		{
+			const int32 BatchSize = FMath::Min(Pending.Num(), K2PostIt::Constants::ReparseBatchSize);
+
+			Batch.Append(Pending.GetData(), BatchSize);
+			Pending.RemoveAt(0, BatchSize, EAllowShrinking::No);
+		}
+		else
+		{
+			TickerHandle.Reset();
+			return false;
+		}
+	}
+
+	TArray<TWeakObjectPtr<UEdGraphNode_K2PostIt>> StillLoading;
+
+	for (int32 i = Batch.Num() - 1; i >= 0; --i)
+	{
+		UEdGraphNode_K2PostIt* Node = Batch[i].Get();
+
+		if (Node == nullptr)
+		{
+			Batch.RemoveAtSwap(i);
+		}
+		else if (Node->HasAnyFlags(RF_NeedLoad | RF_NeedPostLoad) || Node->HasAnyInternalFlags(EInternalObjectFlags::Async))
+		{
+			// Enqueued from PostLoad on the loading thread, its comment text may not be read yet
+			StillLoading.Add(Batch[i]);
+			Batch.RemoveAtSwap(i);
+		}
+	}
+
+	if (!StillLoading.IsEmpty())
+	{
+		FScopeLock ScopeLock(&Lock);
+
+		(bUrgent ? Urgent : Pending).Append(MoveTemp(StillLoading));
+	}
+
+	if (Batch.IsEmpty())
+	{
+		return true;
+	}
+
+	TArray<FText> Texts;
+	Texts.Reserve(Batch.Num());
+
+	for (const TWeakObjectPtr<UEdGraphNode_K2PostIt>& Node : Batch)
+	{
+		Texts.Add(Node->GetCommentText());
+	}
+
+	bBatchInFlight = true;
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION,
+		[Batch = MoveTemp(Batch), Texts = MoveTemp(Texts), bUrgent] () mutable
+		{
+			TArray<FK2PostItDocumentRef> Results;
+			Results.Init(FK2PostItDocument::GetEmpty(), Texts.Num());
+
+			ParallelFor(Texts.Num(), [&Texts, &Results] (int32 Index)
+			{
+				TSharedRef<FK2PostItDocument> Parsed = MakeShared<FK2PostItDocument>();
+				FK2PostItAsyncParser::PeasantTextToRichText(Texts[Index].ToString(), *Parsed);
+				Results[Index] = Parsed;
+			},
+			bUrgent ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+			AsyncTask(ENamedThreads::GameThread, [Batch = MoveTemp(Batch), Texts = MoveTemp(Texts), Results = MoveTemp(Results)]
+			{
+				for (int32 i = 0; i < Batch.Num(); ++i)
+				{
+					if (UEdGraphNode_K2PostIt* Node = Batch[i].Get())
+					{
+						Node->ApplyReparsedDocument(Texts[i].ToString(), Results[i]);
+					}
+				}
+
+				Get().bBatchInFlight = false;
+			});
+		},
+
+		bUrgent ? LowLevelTasks::ETaskPriority::Normal : LowLevelTasks::ETaskPriority::BackgroundLow
+	);
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#undef LOCTEXT_NAMESPACE
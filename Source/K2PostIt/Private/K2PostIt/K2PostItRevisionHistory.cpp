@@ -0,0 +1,203 @@
+// Unlicensed. This file is public domain.
+
+#include "K2PostIt/K2PostItRevisionHistory.h"
+
+#include "K2PostIt/K2PostItProjectSettings.h"
+#include "Serialization/Archive.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+namespace K2PostIt::RevisionHistory
+{
+	/** Per revision overhead counted against the byte budget, roughly its serialized header */
+	constexpr int32 RevisionOverhead = 16;
+
+	// --------------------------------------------------------------------------------------------
+
+	static void SerializePacked(FArchive& Ar, int32& Value)
+	{
+		uint32 Packed = static_cast<uint32>(Value);
+		Ar.SerializeIntPacked(Packed);
+		Value = static_cast<int32>(Packed);
+	}
+
+	// --------------------------------------------------------------------------------------------
+
+	/** A run of characters in the current body or in a revision's middle */
+	struct FPiece
+	{
+		const TCHAR* Data = nullptr;
+
+		int32 Len = 0;
+	};
+
+	/** Appends the pieces covering characters [Start, Start + Len) of the text Pieces make up */
+	static void AppendRange(const TArray<FPiece>& Pieces, int32 Start, int32 Len, TArray<FPiece>& OutPieces)
+	{
+		for (const FPiece& Piece : Pieces)
+		{
+			if (Len <= 0)
+			{
+				break;
+			}
+
+			if (Start >= Piece.Len)
+			{
+				Start -= Piece.Len;
+				continue;
+			}
+
+			const int32 Taken = FMath::Min(Piece.Len - Start, Len);
+			OutPieces.Add({ Piece.Data + Start, Taken });
+
+			Start = 0;
+			Len -= Taken;
+		}
+	}
+}
+
+// ================================================================================================
+
+void FK2PostItRevisionHistory::Push(FStringView OldText, FStringView NewText)
+{
+	const int32 MaxShared = FMath::Min(OldText.Len(), NewText.Len());
+
+	int32 PrefixLen = 0;
+
+	while (PrefixLen < MaxShared && OldText[PrefixLen] == NewText[PrefixLen])
+	{
+		++PrefixLen;
+	}
+
+	int32 SuffixLen = 0;
+
+	while (SuffixLen < MaxShared - PrefixLen && OldText[OldText.Len() - 1 - SuffixLen] == NewText[NewText.Len() - 1 - SuffixLen])
+	{
+		++SuffixLen;
+	}
+
+	FRevision Revision;
+	Revision.PrefixLen = PrefixLen;
+	Revision.SuffixLen = SuffixLen;
+	Revision.Middle = FString(OldText.Mid(PrefixLen, OldText.Len() - PrefixLen - SuffixLen));
+	Revision.Timestamp = FDateTime::UtcNow();
+
+	Revisions.Insert(MoveTemp(Revision), 0);
+
+	// The oldest revisions are at the end of the chain, so they can be dropped without touching the others
+	const int32 MaxRevisions = UK2PostItProjectSettings::GetMaxRevisions();
+	const int32 ByteBudget = UK2PostItProjectSettings::GetRevisionHistoryByteBudget();
+
+	while (Revisions.Num() > MaxRevisions || (Revisions.Num() > 0 && GetSize() > ByteBudget))
+	{
+		Revisions.Pop(EAllowShrinking::No);
+	}
+
+	Revisions.Shrink();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FK2PostItRevisionHistory::GetRevision(FStringView CurrentText, int32 Index) const
+{
+	using namespace K2PostIt::RevisionHistory;
+
+	check(Revisions.IsValidIndex(Index));
+
+	// The deltas are applied to a list of pieces pointing into the current body and the stored middles, and the text is only built once at the end.
+	// Each step adds at most three pieces, so walking back N revisions costs O(N^2) piece operations, N being capped by GetMaxRevisions, plus one
+	// copy of the result, rather than a copy of the whole body per step.
+	TArray<FPiece> Pieces;
+	Pieces.Add({ CurrentText.GetData(), CurrentText.Len() });
+
+	TArray<FPiece> Next;
+	int32 Len = CurrentText.Len();
+
+	for (int32 i = 0; i <= Index; ++i)
+	{
+		const FRevision& Revision = Revisions[i];
+
+		if (!ensure(Revision.PrefixLen >= 0 && Revision.SuffixLen >= 0 && Revision.PrefixLen + Revision.SuffixLen <= Len))
+		{
+			return FString();
+		}
+
+		Next.Reset();
+		AppendRange(Pieces, 0, Revision.PrefixLen, Next);
+
+		if (!Revision.Middle.IsEmpty())
+		{
+			Next.Add({ *Revision.Middle, Revision.Middle.Len() });
+		}
+
+		AppendRange(Pieces, Len - Revision.SuffixLen, Revision.SuffixLen, Next);
+
+		Swap(Pieces, Next);
+		Len = Revision.PrefixLen + Revision.Middle.Len() + Revision.SuffixLen;
+	}
+
+	FString Text;
+	Text.Reserve(Len);
+
+	for (const FPiece& Piece : Pieces)
+	{
+		Text.Append(Piece.Data, Piece.Len);
+	}
+
+	return Text;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FK2PostItRevisionHistory::Serialize(FArchive& Ar)
+{
+	using namespace K2PostIt::RevisionHistory;
+
+	int32 NumRevisions = Revisions.Num();
+	SerializePacked(Ar, NumRevisions);
+
+	if (Ar.IsLoading())
+	{
+		if (NumRevisions < 0 || (Ar.TotalSize() >= 0 && NumRevisions > Ar.TotalSize() - Ar.Tell()))
+		{
+			Ar.SetError();
+			return;
+		}
+
+		Revisions.Reset();
+		Revisions.SetNum(NumRevisions);
+	}
+
+	for (FRevision& Revision : Revisions)
+	{
+		SerializePacked(Ar, Revision.PrefixLen);
+		SerializePacked(Ar, Revision.SuffixLen);
+		Ar << Revision.Middle;
+		Ar << Revision.Timestamp;
+	}
+
+	if (Ar.IsLoading() && Ar.IsError())
+	{
+		Revisions.Empty();
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 FK2PostItRevisionHistory::GetSize() const
+{
+	int32 Size = 0;
+
+	for (const FRevision& Revision : Revisions)
+	{
+		Size += K2PostIt::RevisionHistory::RevisionOverhead + Revision.Middle.Len() * sizeof(TCHAR);
+	}
+
+	return Size;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#undef LOCTEXT_NAMESPACE
@@ -2,20 +2,28 @@
 
 #include "K2PostIt/Nodes/EdGraphNode_K2PostIt.h"
 
+#include "Async/Async.h"
 #include "BlueprintActionDatabaseRegistrar.h"
 #include "BlueprintNodeSpawner.h"
+#include "Editor.h"
 #include "Framework/Application/SlateApplication.h"
 #include "GraphEditorSettings.h"
 #include "ScopedTransaction.h"
 #include "Internationalization/Internationalization.h"
 #include "K2PostIt/K2PostItAsyncParser.h"
+#include "K2PostIt/K2PostItCustomVersion.h"
+#include "K2PostIt/K2PostItDocumentPool.h"
+#include "K2PostIt/K2PostItParseCache.h"
 #include "K2PostIt/K2PostItProjectSettings.h"
+#include "K2PostIt/K2PostItReparseQueue.h"
 #include "K2PostIt/Widgets/SGraphNode_K2PostIt.h"
 #include "Kismet2/BlueprintEditorUtils.h"
 #include "Kismet2/Kismet2NameValidators.h"
 #include "Kismet2/KismetEditorUtilities.h"
 #include "Layout/SlateRect.h"
 #include "Misc/AssertionMacros.h"
+#include "Misc/OutputDevice.h"
+#include "Misc/Parse.h"
 #include "Styling/AppStyle.h"
 #include "Templates/Casts.h"
 #include "UObject/Class.h"
@@ -70,9 +78,23 @@ UEdGraphNode_K2PostIt::UEdGraphNode_K2PostIt(const FObjectInitializer& ObjectIni
 
 // ------------------------------------------------------------------------------------------------
 
-TArray<TInstancedStruct<FK2PostIt_BaseBlock>>& UEdGraphNode_K2PostIt::GetBlocks()
+const FK2PostItDocument& UEdGraphNode_K2PostIt::GetBlocks() const
 {
-	return Blocks;
+	return *Document;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float UEdGraphNode_K2PostIt::GetMeasuredHeight(int32 Width) const
+{
+	return MeasuredAtWidth == Width && MeasuredAtFontSize == TitleFontSize ? MeasuredHeight : 0.0f;
+}
+
+void UEdGraphNode_K2PostIt::SetMeasuredHeight(int32 Width, float Height)
+{
+	MeasuredAtWidth = Width;
+	MeasuredAtFontSize = TitleFontSize;
+	MeasuredHeight = Height;
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -88,6 +110,103 @@ bool UEdGraphNode_K2PostIt::ConsumeFirstPlacement()
 
 // ------------------------------------------------------------------------------------------------
 
+void UEdGraphNode_K2PostIt::Serialize(FArchive& Ar)
+{
+	Ar.UsingCustomVersion(FK2PostItCustomVersion::GUID);
+
+	Super::Serialize(Ar);
+
+	// In-memory archives (duplication) carry no custom versions, they are always written by this build
+	const int32 DataVersion = Ar.IsPersistent() ? Ar.CustomVer(FK2PostItCustomVersion::GUID) : FK2PostItCustomVersion::LatestVersion;
+
+	// Set when the body was stored compressed, it becomes ColdCommentText once the document has been loaded against the plain text
+	FK2PostItCompressedText LoadedCompressedText;
+
+	if (Ar.IsLoading() && DataVersion < FK2PostItCustomVersion::CommentBodyString)
+	{
+		CommentText = FText::AsCultureInvariant(CommentText_DEPRECATED.ToString());
+		CommentText_DEPRECATED = FText::GetEmpty();
+	}
+	else if (Ar.IsLoading() && DataVersion < FK2PostItCustomVersion::CompressedCommentBody)
+	{
+		FString Body;
+		Ar << Body;
+		CommentText = FText::AsCultureInvariant(MoveTemp(Body));
+	}
+	else if (Ar.IsLoading())
+	{
+		FString Body;
+
+		if (!FK2PostItCompressedText::Load(Ar, Body, LoadedCompressedText))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("K2PostIt: could not read the comment body of %s"), *GetPathName());
+		}
+
+		CommentText = FText::AsCultureInvariant(MoveTemp(Body));
+		ColdCommentText.Reset();
+	}
+	else if (Ar.IsSaving())
+	{
+		// Transactions include the body, it is the one piece of comment state that undo must restore. They are not compressed, that
+		// would slow every edit down, but a body that is already compressed is written as it is.
+		if (!ColdCommentText.IsEmpty())
+		{
+			ColdCommentText.Save(Ar);
+		}
+		else
+		{
+			const FString& Body = CommentText.ToString();
+			FK2PostItCompressedText::Save(Ar, Body, Ar.IsPersistent() && FK2PostItCompressedText::ShouldCompress(Body.Len()));
+		}
+	}
+
+	if (Ar.IsLoading() && DataVersion < FK2PostItCustomVersion::CompactDocument)
+	{
+		// Older assets stored the parsed blocks in the tagged Blocks array
+		Document = FK2PostItDocumentPool::Intern(MakeShared<FK2PostItDocument>(FK2PostItDocument::FromBlocks(Blocks)));
+		Blocks.Empty();
+	}
+	else if ((Ar.IsLoading() || Ar.IsSaving()) && !Ar.IsTransacting())
+	{
+		// Must come after Super::Serialize, the document stores ranges of the comment text instead of copies where it can.
+		// Transactions skip it, the document is derived from the comment text and PostEditUndo brings it back.
+		if (Ar.IsSaving() && !ColdCommentText.IsEmpty())
+		{
+			// Saving should not leave the body decompressed
+			Document->Save(Ar, ColdCommentText.Decompress());
+		}
+		else if (Ar.IsSaving())
+		{
+			Document->Save(Ar, CommentText.ToString());
+		}
+		else
+		{
+			TSharedRef<FK2PostItDocument> Loaded = MakeShared<FK2PostItDocument>();
+
+			if (!Loaded->Load(Ar, CommentText.ToString(), DataVersion))
+			{
+				UE_LOG(LogTemp, Verbose, TEXT("K2PostIt: stored blocks for %s do not match the comment text, they will be re-parsed"), *GetPathName());
+			}
+
+			Document = FK2PostItDocumentPool::Intern(Loaded);
+		}
+	}
+
+	// Editor-only, and only present when the project keeps revision history (an empty history is a single byte)
+	if (!Ar.IsFilterEditorOnly() && (Ar.IsSaving() || (Ar.IsLoading() && DataVersion >= FK2PostItCustomVersion::RevisionHistory)))
+	{
+		RevisionHistory.Serialize(Ar);
+	}
+
+	if (!LoadedCompressedText.IsEmpty() && NumVisualWidgets == 0)
+	{
+		ColdCommentText = MoveTemp(LoadedCompressedText);
+		CommentText = FText::GetEmpty();
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
 void UEdGraphNode_K2PostIt::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
 	if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(UEdGraphNode_K2PostIt, bCommentBubbleVisible_InDetailsPanel))
@@ -97,6 +216,8 @@ void UEdGraphNode_K2PostIt::PostEditChangeProperty(FPropertyChangedEvent& Proper
 	}
 	
 	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	OnAppearanceChangedEvent.Broadcast();
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -116,6 +237,26 @@ void UEdGraphNode_K2PostIt::PostPlacedNewNode()
 
 // ------------------------------------------------------------------------------------------------
 
+void UEdGraphNode_K2PostIt::PostPasteNode()
+{
+	Super::PostPasteNode();
+
+	// Clipboard text does not carry the parsed document. Copying put it in the parse cache, failing that the pasted nodes are parsed together in one batch.
+	if (Document->IsEmpty() && HasCommentText())
+	{
+		if (FK2PostItDocumentPtr Cached = FK2PostItParseCache::Find(GetCommentText().ToString()))
+		{
+			Document = Cached.ToSharedRef();
+		}
+		else
+		{
+			FK2PostItReparseQueue::Enqueue(this, true);
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
 FText UEdGraphNode_K2PostIt::GetTooltipText() const
 {
 	if (NodeComment.IsEmpty())
@@ -274,24 +415,235 @@ bool UEdGraphNode_K2PostIt::IsSelectedInEditor() const
 void UEdGraphNode_K2PostIt::PostLoad()
 {
 	Super::PostLoad();
+
+	// PostLoad is not marked thread-safe, as UK2Node and UEdGraphNode do not declare theirs to be. Should it ever run off the game thread,
+	// the document work still waits for it.
+	if (!IsInGameThread())
+	{
+		AsyncTask(ENamedThreads::GameThread, [WeakThis = TWeakObjectPtr<UEdGraphNode_K2PostIt>(this)]
+		{
+			if (UEdGraphNode_K2PostIt* Node = WeakThis.Get())
+			{
+				Node->RefreshLoadedDocument();
+			}
+		});
+
+		return;
+	}
+
+	RefreshLoadedDocument();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UEdGraphNode_K2PostIt::RefreshLoadedDocument()
+{
+	check(IsInGameThread());
+
+	// Reads the stored body directly rather than through GetCommentText, a compressed body stays compressed
+	if (HasCommentText() && (Document->IsEmpty() || Document->GetParserVersion() != FK2PostItAsyncParser::Version))
+	{
+		FString Decompressed;
+		const FString& Body = ColdCommentText.IsEmpty() ? CommentText.ToString() : (Decompressed = ColdCommentText.Decompress());
+
+		FK2PostItDocumentPtr Cached = FK2PostItParseCache::Find(Body);
+
+		if (!Cached.IsValid() || Cached->GetParserVersion() != FK2PostItAsyncParser::Version)
+		{
+			// Stored blocks that could not be loaded, or that an older version of the parser produced, are rebuilt in the background
+			FK2PostItReparseQueue::Enqueue(this);
+			return;
+		}
+
+		Document = Cached.ToSharedRef();
+	}
+
+	CompressCommentTextIfUnused();
 }
 
+// ------------------------------------------------------------------------------------------------
+
+void UEdGraphNode_K2PostIt::ApplyReparsedDocument(const FString& SourceText, FK2PostItDocumentRef NewDocument)
+{
+	// The comment may have been edited while it was queued, in which case the edit's own parse wins
+	if (ActiveParser.IsValid() || PreTransactionDocument.IsValid() || !GetCommentText().ToString().Equals(SourceText, ESearchCase::CaseSensitive))
+	{
+		return;
+	}
+
+	const bool bOutputChanged = *NewDocument != *Document;
+
+	// Taken even when the output is unchanged, for its new parser version stamp. The next save of the package writes it, after which the node
+	// is no longer reparsed on load. Cached too, so other nodes with the same text loaded this session pick it up instead of reparsing.
+	Document = FK2PostItParseCache::Add(SourceText, FK2PostItDocumentPool::Intern(NewDocument));
+
+	// Only ask for a resave when the rendering actually changed, a bumped parser version alone is not worth touching every asset
+	if (bOutputChanged)
+	{
+		MarkPackageDirty();
+		OnBlocksUpdatedEvent.Broadcast();
+	}
+
+	CompressCommentTextIfUnused();
+}
+
+// ------------------------------------------------------------------------------------------------
+
 void UEdGraphNode_K2PostIt::PostEditUndo()
 {
 	Super::PostEditUndo();
 
-	SetPreviewCommentText(CommentText);
+	OnAppearanceChangedEvent.Broadcast();
+
+	// The parsed document is not part of the transaction, get it back for the restored comment text
+	if (FK2PostItDocumentPtr Cached = FK2PostItParseCache::Find(GetCommentText().ToString()))
+	{
+		Document = Cached.ToSharedRef();
+		OnBlocksUpdatedEvent.Broadcast();
+	}
+	else
+	{
+		StartParser(GetCommentText());
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+namespace FEdGraphNode_K2PostIt_Utils
+{
+	static const TCHAR* CommentBodyCustomProperty = TEXT("K2PostItCommentBody");
+}
+
+void UEdGraphNode_K2PostIt::ExportCustomProperties(FOutputDevice& Out, uint32 Indent)
+{
+	Super::ExportCustomProperties(Out, Indent);
+
+	// The body is not a property, so copy/paste and T3D export need it written out explicitly. The document is not exported, it is left in the
+	// parse cache for the paste to pick up instead.
+	if (HasCommentText())
+	{
+		if (!Document->IsEmpty())
+		{
+			Document = FK2PostItParseCache::Add(GetCommentText().ToString(), Document);
+		}
+
+		Out.Logf(TEXT("%sCustomProperties %s \"%s\"\r\n"), FCString::Spc(Indent), FEdGraphNode_K2PostIt_Utils::CommentBodyCustomProperty, *GetCommentText().ToString().ReplaceCharWithEscapedChar());
+	}
+}
+
+void UEdGraphNode_K2PostIt::ImportCustomProperties(const TCHAR* SourceText, FFeedbackContext* Warn)
+{
+	const TCHAR* Cursor = SourceText;
+
+	if (FParse::Command(&Cursor, FEdGraphNode_K2PostIt_Utils::CommentBodyCustomProperty))
+	{
+		FString Body;
+
+		if (FParse::QuotedString(Cursor, Body))
+		{
+			CommentText = FText::AsCultureInvariant(MoveTemp(Body));
+			ColdCommentText.Reset();
+		}
+
+		return;
+	}
+
+	Super::ImportCustomProperties(SourceText, Warn);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+const FText& UEdGraphNode_K2PostIt::GetCommentText() const
+{
+	check(IsInGameThread());
+
+	if (!ColdCommentText.IsEmpty())
+	{
+		CommentText = FText::AsCultureInvariant(ColdCommentText.Decompress());
+		ColdCommentText.Reset();
+	}
+
+	return CommentText;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UEdGraphNode_K2PostIt::AddVisualWidget()
+{
+	++NumVisualWidgets;
+}
+
+void UEdGraphNode_K2PostIt::RemoveVisualWidget()
+{
+	check(NumVisualWidgets > 0);
+
+	if (--NumVisualWidgets == 0 && GEditor)
+	{
+		// Refreshing a graph destroys and recreates all of its node widgets, waiting a tick avoids compressing a body only to decompress it again
+		GEditor->GetTimerManager()->SetTimerForNextTick(FTimerDelegate::CreateWeakLambda(this, [this] ()
+		{
+			CompressCommentTextIfUnused();
+		}));
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UEdGraphNode_K2PostIt::CompressCommentTextIfUnused()
+{
+	if (NumVisualWidgets > 0 || ActiveParser.IsValid() || bSetCommentTextRequestPending || PreTransactionDocument.IsValid() || !ColdCommentText.IsEmpty())
+	{
+		return;
+	}
+
+	const FString& Body = CommentText.ToString();
+
+	if (FK2PostItCompressedText::ShouldCompress(Body.Len()) && ColdCommentText.Compress(Body))
+	{
+		CommentText = FText::GetEmpty();
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 UEdGraphNode_K2PostIt::GetCommentTextSize() const
+{
+	if (!ColdCommentText.IsEmpty())
+	{
+		return ColdCommentText.GetUncompressedSize();
+	}
+
+	const FString& Body = CommentText.ToString();
+	return FTCHARToUTF8(Body.GetCharArray().GetData(), Body.Len()).Length();
+}
+
+int32 UEdGraphNode_K2PostIt::GetSavedCommentTextSize() const
+{
+	if (!ColdCommentText.IsEmpty())
+	{
+		return ColdCommentText.GetCompressedSize();
+	}
+
+	const FString& Body = CommentText.ToString();
+
+	FK2PostItCompressedText Compressed;
+
+	if (FK2PostItCompressedText::ShouldCompress(Body.Len()) && Compressed.Compress(Body))
+	{
+		return Compressed.GetCompressedSize();
+	}
+
+	return GetCommentTextSize();
 }
 
 // ------------------------------------------------------------------------------------------------
 
 void UEdGraphNode_K2PostIt::AbortCommentEdit()
 {
-	if (bPreTransactionBlocksSet)
+	if (PreTransactionDocument.IsValid())
 	{
-		Blocks = PreTransactionBlocks;
-		PreTransactionBlocks.Empty();
-		bPreTransactionBlocksSet = false;
+		Document = PreTransactionDocument.ToSharedRef();
+		PreTransactionDocument.Reset();
 		
 		OnBlocksUpdatedEvent.Broadcast();
 	}
@@ -306,11 +658,10 @@ void UEdGraphNode_K2PostIt::SetCommentText(const FText& Text)
 		FScopedTransaction Transaction(TEXT("K2PostIt"), LOCTEXT("Transaction_ChangeCommentText", "Change Comment Text"), this, true);
 		Modify();
 		
-		CommentText = Text;
+		CommitCommentText(Text);
 		bSetCommentTextRequestPending = false;
 		PendingCommentText = FText::GetEmpty();
-		bPreTransactionBlocksSet = false;
-		PreTransactionBlocks.Empty();
+		PreTransactionDocument.Reset();
 	}
 	else
 	{
@@ -325,21 +676,52 @@ void UEdGraphNode_K2PostIt::SetPreviewCommentText(const FText& Text)
 {
 	UE_LOG(LogTemp, VeryVerbose, TEXT("SetPreviewCommentText"));
 
-	// We're going to stash a copy of the last saved Blocks when we start editing the comment. If the user aborts editing the comment node then we'll switch back to it.
-	if (!bPreTransactionBlocksSet)
+	// We're going to stash the last saved document when we start editing the comment. If the user aborts editing the comment node then we'll switch back to it.
+	if (!PreTransactionDocument.IsValid())
 	{
-		PreTransactionBlocks = Blocks;
-		bPreTransactionBlocksSet = true;
+		// Undoing the edit will ask for the document of the current text, which may have come from disk rather than the parser
+		if (!Document->IsEmpty())
+		{
+			Document = FK2PostItParseCache::Add(GetCommentText().ToString(), Document);
+		}
+
+		PreTransactionDocument = Document;
 	}
-	
+
+	StartParser(Text);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UEdGraphNode_K2PostIt::CommitCommentText(const FText& Text)
+{
+	if (UK2PostItProjectSettings::GetKeepRevisionHistory())
+	{
+		const FString& OldText = GetCommentText().ToString();
+		const FString& NewText = Text.ToString();
+
+		if (!OldText.IsEmpty() && !OldText.Equals(NewText, ESearchCase::CaseSensitive))
+		{
+			RevisionHistory.Push(OldText, NewText);
+		}
+	}
+
+	CommentText = Text;
+	ColdCommentText.Reset();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UEdGraphNode_K2PostIt::StartParser(const FText& Text)
+{
 	if (ActiveParser.IsValid())
 	{
-		QueuedParser = MakeShared<FK2PostItAsyncParser>(Text.ToString());
+		QueuedParser = MakeShared<FK2PostItAsyncParser>(Text);
 		QueuedParser->OnParseComplete.AddUObject(this, &ThisClass::OnParseComplete);
 	}
 	else
 	{
-		ActiveParser = MakeShared<FK2PostItAsyncParser>(Text.ToString());
+		ActiveParser = MakeShared<FK2PostItAsyncParser>(Text);
 		ActiveParser->OnParseComplete.AddUObject(this, &ThisClass::OnParseComplete);
 		ActiveParser->RunParser();	
 	}
@@ -354,7 +736,7 @@ void UEdGraphNode_K2PostIt::SetSelectionState(const ESelectionState InSelectionS
 
 // ------------------------------------------------------------------------------------------------
 
-void UEdGraphNode_K2PostIt::OnParseComplete(TArray<TInstancedStruct<FK2PostIt_BaseBlock>> NewBlocks)
+void UEdGraphNode_K2PostIt::OnParseComplete(FK2PostItDocumentRef NewDocument)
 {
 	// This is normally updating the preview, but it's possible to commit new comment text while it's running.
 
@@ -367,6 +749,8 @@ void UEdGraphNode_K2PostIt::OnParseComplete(TArray<TInstancedStruct<FK2PostIt_Ba
 	
 	UE_LOG(LogTemp, VeryVerbose, TEXT("OnParseComplete"));
 
+	NewDocument = FK2PostItDocumentPool::Intern(NewDocument);
+
 	// bSetCommentTextRequestPending is set by the SetCommentText function when there is a parser running
 	FScopedTransaction Transaction(TEXT("K2PostIt"), LOCTEXT("Transaction_ChangeCommentText", "Change Comment Text"), this, bSetCommentTextRequestPending);
 	
@@ -374,17 +758,16 @@ void UEdGraphNode_K2PostIt::OnParseComplete(TArray<TInstancedStruct<FK2PostIt_Ba
 	if (bSetCommentTextRequestPending && !QueuedParser.IsValid())
 	{
 		Modify();
-		CommentText = PendingCommentText;
+		CommitCommentText(PendingCommentText);
 		bSetCommentTextRequestPending = false;
 		PendingCommentText = FText::GetEmpty();
 		
-		Blocks = NewBlocks;
-		bPreTransactionBlocksSet = false;
-		PreTransactionBlocks.Empty();
+		Document = NewDocument;
+		PreTransactionDocument.Reset();
 	}
 	else // Just update the blocks for preview
 	{
-		Blocks = NewBlocks;
+		Document = NewDocument;
 	}
 	
 	ActiveParser = nullptr;
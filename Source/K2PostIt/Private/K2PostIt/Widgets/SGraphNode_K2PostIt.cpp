@@ -16,17 +16,22 @@
 #include "InputCoreTypes.h"
 #include "Internationalization/Text.h"
 #include "K2PostIt/Globals/K2PostItConstants.h"
-#include "K2PostIt/K2PostItAsyncParser.h"
+#include "K2PostIt/K2PostItBlockWidgets.h"
 #include "K2PostIt/K2PostItColor.h"
+#include "K2PostIt/K2PostItGraphViewTracker.h"
 #include "K2PostIt/K2PostItProjectSettings.h"
+#include "K2PostIt/K2PostItRenderContext.h"
 #include "K2PostIt/K2PostItStyle.h"
 #include "K2PostIt/Nodes/EdGraphNode_K2PostIt.h"
+#include "K2PostIt/Widgets/SK2PostItBlockList.h"
 #include "K2PostIt/Widgets/SWindow_K2PostIt.h"
 #include "Layout/ChildrenBase.h"
 #include "Layout/Geometry.h"
 #include "Layout/Margin.h"
+#include "Layout/WidgetPath.h"
 #include "Math/Color.h"
 #include "Misc/Attribute.h"
+#include "Misc/CoreDelegates.h"
 #include "Misc/Guid.h"
 #include "SCommentBubble.h"
 #include "ScopedTransaction.h"
@@ -52,8 +57,10 @@
 #include "Widgets/Layout/SWidgetSwitcher.h"
 #include "Widgets/Notifications/SErrorText.h"
 #include "Widgets/SBoxPanel.h"
+#include "Widgets/SInvalidationPanel.h"
 #include "Widgets/Text/SInlineEditableTextBlock.h"
 #include "Widgets/Text/SRichTextBlock.h"
+#include "Widgets/Text/STextBlock.h"
 
 class FDragDropEvent;
 
@@ -82,6 +89,91 @@ namespace SCommentNodeDefs
 
 // ================================================================================================
 
+namespace K2PostIt::PreviewPanel
+{
+	/** One markdown preview window per graph panel, moved to whichever of its nodes is being edited instead of built for every edit */
+	struct FSharedPreviewPanel
+	{
+		TWeakPtr<SGraphPanel> Panel;
+
+		TSharedPtr<SWindow_K2PostIt> Window;
+
+		/** Holds the owner's PreviewTextPanel */
+		TSharedPtr<SBorder> Border;
+
+		TWeakPtr<SGraphNode_K2PostIt> Owner;
+	};
+
+	static TArray<FSharedPreviewPanel>& GetAll()
+	{
+		static TArray<FSharedPreviewPanel> Instances;
+		static bool bRegistered = false;
+
+		if (!bRegistered)
+		{
+			// Slate widgets must not outlive Slate
+			FCoreDelegates::OnPreExit.AddLambda([] ()
+			{
+				Instances.Empty();
+			});
+
+			bRegistered = true;
+		}
+
+		return Instances;
+	}
+
+	/** Returns the panel's preview window if it has one */
+	static FSharedPreviewPanel* Find(const SGraphPanel* Panel)
+	{
+		if (Panel == nullptr)
+		{
+			return nullptr;
+		}
+
+		return GetAll().FindByPredicate([Panel] (const FSharedPreviewPanel& PreviewPanel)
+		{
+			return PreviewPanel.Panel.Pin().Get() == Panel;
+		});
+	}
+
+	static FSharedPreviewPanel& Get(const TSharedRef<SGraphPanel>& Panel)
+	{
+		TArray<FSharedPreviewPanel>& Instances = GetAll();
+
+		// The windows of closed graphs go with them
+		Instances.RemoveAllSwap([] (const FSharedPreviewPanel& PreviewPanel) { return !PreviewPanel.Panel.IsValid(); });
+
+		if (FSharedPreviewPanel* Existing = Find(&Panel.Get()))
+		{
+			return *Existing;
+		}
+
+		FSharedPreviewPanel& Instance = Instances.AddDefaulted_GetRef();
+		Instance.Panel = Panel;
+
+		Instance.Window = SNew(SWindow_K2PostIt)
+		.CreateTitleBar(false)
+		.InitialOpacity(0.0)
+		.SizingRule(ESizingRule::Autosized)
+		.LayoutBorder(.0f)
+		[
+			SNew(SBox)
+			.WidthOverride(120.0f)
+			[
+				SAssignNew(Instance.Border, SBorder)
+				.BorderImage( FK2PostItStyle::GetImageBrush(K2PostItBrushes.PreviewPaneBorder))
+				.ColorAndOpacity( FLinearColor::White )
+				.Padding(8)
+			]
+		];
+
+		return Instance;
+	}
+}
+
+// ================================================================================================
+
 FCursorReply SGraphNode_K2PostIt::OnCursorQuery(const FGeometry& MyGeometry, const FPointerEvent& CursorEvent) const
 {
 	switch (MouseZone)
@@ -122,7 +214,25 @@ FCursorReply SGraphNode_K2PostIt::OnCursorQuery(const FGeometry& MyGeometry, con
 
 void SGraphNode_K2PostIt::OnParseComplete()
 {
-	RebuildRichText();
+	bOutlineDirty = true;
+
+	if (PreviewTextPanel.IsValid())
+	{
+		PreviewTextPanel->SetBlocks(GetBlockKeys());
+	}
+
+	if (CachedBodyDetail == EBodyDetail::Full)
+	{
+		RebuildRichText();
+	}
+	else
+	{
+		bRichTextDeferred = true;
+		Invalidate(EInvalidateWidgetReason::Layout);
+	}
+
+	// The outline is rebuilt, and the node's size may have changed
+	FK2PostItGraphViewTracker::Refresh(SharedThis(this));
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -142,6 +252,8 @@ void SGraphNode_K2PostIt::Construct(const FArguments& InArgs, UEdGraphNode_K2Pos
 	CachedCommentTitle = GetNodeComment();
 	CachedWidth = InNode->NodeWidth;
 
+	RenderContext = MakeShared<FK2PostItRenderContext>(SharedThis(this));
+
 	this->UpdateGraphNode();
 
 	// Pull out sizes
@@ -155,31 +267,191 @@ void SGraphNode_K2PostIt::Construct(const FArguments& InArgs, UEdGraphNode_K2Pos
 	bUserIsDragging = false;
 
 	InNode->OnBlocksUpdatedEvent.AddSP(this, &SGraphNode_K2PostIt::OnParseComplete);
+	InNode->OnAppearanceChangedEvent.AddSP(this, &SGraphNode_K2PostIt::OnAppearanceChanged);
+
+	CountedNode = InNode;
+	InNode->AddVisualWidget();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+SGraphNode_K2PostIt::~SGraphNode_K2PostIt()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(OffscreenBodyTicker);
+
+	DetachPreviewPanel();
+	ReleaseBlockWidgets();
+
+	if (UEdGraphNode_K2PostIt* Node = CountedNode.Get())
+	{
+		Node->RemoveVisualWidget();
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::SetOwner(const TSharedRef<SGraphPanel>& OwnerPanel)
+{
+	SGraphNodeResizable::SetOwner(OwnerPanel);
+
+	CachedBodyDetail = ComputeBodyDetail();
+
+	FK2PostItGraphViewTracker::Register(OwnerPanel, SharedThis(this));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::OnGraphViewChanged(const FSlateRect& ViewRect)
+{
+	const EBodyDetail BodyDetail = ComputeBodyDetail();
+
+	if (BodyDetail != CachedBodyDetail)
+	{
+		CachedBodyDetail = BodyDetail;
+		Invalidate(EInvalidateWidgetReason::Layout);
+	}
+
+#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION < 6
+	const FVector2D NodePosition = GetPosition();
+#else
+	const FVector2D NodePosition = FVector2D(GetPosition2f());
+#endif
+	const FSlateRect NodeRect(NodePosition, NodePosition + GetDesiredSize());
+
+	// The same test the graph culls nodes with
+	const bool bNowOnScreen = FSlateRect::DoRectanglesIntersect(NodeRect, ViewRect);
+
+	if (bNowOnScreen != bOnScreen)
+	{
+		bOnScreen = bNowOnScreen;
+		OffScreenSince = FPlatformTime::Seconds();
+	}
+
+	// The editor and the bubble are otherwise only built when the edit button is clicked
+	if (!CommentTextSource.IsValid() && IsMarkdownDisabled())
+	{
+		BuildCommentTextSource();
+	}
+
+	if (!CommentBubble.IsValid() && bCachedBubbleVisibility && GetCurrentLOD() <= EGraphRenderingLOD::LowDetail)
+	{
+		BuildCommentBubble();
+	}
+
+	if (!bOnScreen)
+	{
+		return;
+	}
+
+	if (BodyDetail == EBodyDetail::Outline && bOutlineDirty)
+	{
+		RebuildOutline();
+	}
+	else if (BodyDetail == EBodyDetail::Full && bRichTextDeferred)
+	{
+		RebuildRichText();
+	}
+	else if (BodyDetail == EBodyDetail::Full)
+	{
+		UpdateVisibleBlocks(ViewRect);
+	}
 }
 
 // ------------------------------------------------------------------------------------------------
 
-void SGraphNode_K2PostIt::Tick( const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime )
+void SGraphNode_K2PostIt::UpdateVisibleBlocks(const FSlateRect& ViewRect)
 {
-	SGraphNode::Tick(AllottedGeometry, InCurrentTime, InDeltaTime);
+	const FGeometry& ListGeometry = FormattedTextPanel->GetTickSpaceGeometry();
 
-	const FString CurrentCommentTitle = GetNodeComment();
-	if (CurrentCommentTitle != CachedCommentTitle)
+	// Not laid out since it was rebuilt, RebuildRichText has asked for the view again
+	if (ListGeometry.GetLocalSize().IsZero())
 	{
-		CachedCommentTitle = CurrentCommentTitle;
+		return;
 	}
 
+#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION < 6
+	const float NodeTop = GetPosition().Y;
+#else
+	const float NodeTop = GetPosition2f().Y;
+#endif
+
+	// Both geometries are from the same paint, and the node's local units are graph units
+	const float ListTop = NodeTop + GetTickSpaceGeometry().AbsoluteToLocal(ListGeometry.GetAbsolutePosition()).Y;
+
+	if (FormattedTextPanel->SetVisibleRange(ViewRect.Top - ListTop, ViewRect.Bottom - ListTop))
+	{
+		StoreMeasuredHeight();
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::StoreMeasuredHeight()
+{
+	UEdGraphNode_K2PostIt* CommentNode = GetNodeObjAsK2PostIt();
+
+	if (!CommentNode || CachedBodyDetail != EBodyDetail::Full || bRichTextDeferred || WidgetIndex_CommentTextPane() != 1)
+	{
+		return;
+	}
+
+	// Lets the node cull correctly the next time the graph is opened, before its markdown is built
+	MainPanel->SlatePrepass(GetPrepassLayoutScaleMultiplier());
+
+	CommentNode->SetMeasuredHeight(FMath::RoundToInt32(CachedWidth), MainPanel->GetDesiredSize().Y);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FReply SGraphNode_K2PostIt::OnMouseMove(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	FReply Reply = SGraphNodeResizable::OnMouseMove(MyGeometry, MouseEvent);
+
+	// Resizing is the only thing that changes UserSize after construction
 	const int32 CurrentWidth = static_cast<int32>(UserSize.X);
+
 	if (CurrentWidth != CachedWidth)
 	{
 		CachedWidth = CurrentWidth;
+		UpdateRenderContext();
+
+		FK2PostItGraphViewTracker::Refresh(SharedThis(this));
 	}
 
-	UEdGraphNode_K2PostIt* CommentNode = CastChecked<UEdGraphNode_K2PostIt>(GraphNode);
-	if (bCachedBubbleVisibility != CommentNode->bCommentBubbleVisible_InDetailsPanel)
+	return Reply;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::OnMouseEnter(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	SGraphNodeResizable::OnMouseEnter(MyGeometry, MouseEvent);
+
+	// The edit button is only shown while hovered
+	BuildEditButton();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::OnFocusChanging(const FWeakWidgetPath& PreviousFocusPath, const FWidgetPath& NewWidgetPath, const FFocusEvent& InFocusEvent)
+{
+	SGraphNodeResizable::OnFocusChanging(PreviousFocusPath, NewWidgetPath, InFocusEvent);
+
+	if (TitleWidgetPanel.IsValid() && NewWidgetPath.ContainsWidget(TitleWidgetPanel.Get()))
 	{
-		CommentBubble->UpdateBubble();
-		bCachedBubbleVisibility = CommentNode->bCommentBubbleVisible_InDetailsPanel;
+		bTitleWidgetPanelFocused = true;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::OnAppearanceChanged()
+{
+	UEdGraphNode_K2PostIt* CommentNode = GetNodeObjAsK2PostIt();
+
+	if (!CommentNode)
+	{
+		return;
 	}
 
 	if (CachedFontSize != CommentNode->GetFontSize())
@@ -187,16 +459,60 @@ void SGraphNode_K2PostIt::Tick( const FGeometry& AllottedGeometry, const double
 		UpdateGraphNode();
 	}
 
-	if (TitleWidgetPanel->HasAnyUserFocusOrFocusedDescendants())
+	if (bCachedBubbleVisibility != CommentNode->bCommentBubbleVisible_InDetailsPanel)
 	{
-		bTitleWidgetPanelFocused = true;
+		if (CommentBubble.IsValid())
+		{
+			CommentBubble->UpdateBubble();
+		}
+
+		bCachedBubbleVisibility = CommentNode->bCommentBubbleVisible_InDetailsPanel;
 	}
-	
+
+	UpdateRenderContext();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::OnSelectionChanged(bool bSelected)
+{
+	if (bSelected == bIsSelected)
+	{
+		return;
+	}
+
+	bIsSelected = bSelected;
+
 	if (!bIsSelected)
 	{
 		bEditButtonClicked = false;
 		bTitleWidgetPanelFocused = false;
 
+		HideQuickColorPalette();
+	}
+
+	if (PreviewPanelWindow.IsValid())
+	{
+		StartPreviewPanelAnimation();
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::StartPreviewPanelAnimation()
+{
+	if (!PreviewPanelTimer.IsValid())
+	{
+		PreviewPanelTimer = RegisterActiveTimer(0.0f, FWidgetActiveTimerDelegate::CreateSP(this, &SGraphNode_K2PostIt::AnimatePreviewPanel));
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+EActiveTimerReturnType SGraphNode_K2PostIt::AnimatePreviewPanel(double InCurrentTime, float InDeltaTime)
+{
+	if (!bIsSelected)
+	{
 		if (PreviewPanelRenderOpacity > 0)
 		{
 			PreviewPanelRenderOpacity -= 5.0f * InDeltaTime;
@@ -204,11 +520,9 @@ void SGraphNode_K2PostIt::Tick( const FGeometry& AllottedGeometry, const double
 			if (PreviewPanelRenderOpacity <= 0)
 			{
 				PreviewPanelRenderOpacity = 0;
-				PreviewPanelBox->SetContent(SNullWidget::NullWidget);
+				DetachPreviewPanel();
 			}
 		}
-
-		HideQuickColorPalette();
 	}
 	else if (bEditButtonClicked && PreviewPanelRenderOpacity <= 1.0)
 	{
@@ -217,86 +531,282 @@ void SGraphNode_K2PostIt::Tick( const FGeometry& AllottedGeometry, const double
 	}
 
 	UpdatePreviewPanelOpacity();
+
+	// Keeps following the node's size for as long as the preview is open
+	return PreviewPanelWindow.IsValid() ? EActiveTimerReturnType::Continue : EActiveTimerReturnType::Stop;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::UpdateRenderContext()
+{
+	const float PreviousWrapAt = RenderContext->GetWrapAt();
+
+	// The block widgets hold their colors and wrap width rather than polling them, so they only repaint when these change
+	if (RenderContext->Update())
+	{
+		for (const TSharedPtr<SK2PostItBlockList>& BlockList : { FormattedTextPanel, PreviewTextPanel })
+		{
+			if (!BlockList.IsValid())
+			{
+				continue;
+			}
+
+			BlockList->ForEachWidget([] (const TSharedRef<SWidget>& Widget)
+			{
+				K2PostIt::BlockWidgets::RestyleBlock(Widget);
+			});
+
+			if (RenderContext->GetWrapAt() != PreviousWrapAt)
+			{
+				BlockList->ResetMeasurements();
+			}
+		}
+
+		StoreMeasuredHeight();
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FReply SGraphNode_K2PostIt::OnDrop( const FGeometry& MyGeometry, const FDragDropEvent& DragDropEvent )
+{
+	return FReply::Unhandled();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::OnDragEnter( const FGeometry& MyGeometry, const FDragDropEvent& DragDropEvent )
+{
+
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float SGraphNode_K2PostIt::GetWrapAt() const
+{
+	return CachedWidth - 32.0f;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FSlateColor SGraphNode_K2PostIt::ForegroundColor_TitleBorder() const
+{
+	return RenderContext->GetTheme().FontColor;
 }
 
-// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+
+FMargin SGraphNode_K2PostIt::Padding_MarkdownPreviewPanel() const
+{
+	float MainPanelWidth = MainPanel->GetCachedGeometry().Size.X;
+
+	const float InnerBorderPadding = K2PostIt::Constants::PreviewPanelPadding;
+	const float Gap = K2PostIt::Constants::PreviewPanelGapToEditPanel;
+	
+	return FMargin(MainPanelWidth + Gap, 0, -MainPanelWidth - Gap - InnerBorderPadding, -9999);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::RebuildRichText()
+{
+	UE_LOG(LogTemp, VeryVerbose, TEXT("RebuildRichText"));
+
+	if (bRichTextDeferred)
+	{
+		bRichTextDeferred = false;
+		Invalidate(EInvalidateWidgetReason::Layout);
+	}
+
+	UEdGraphNode_K2PostIt* CommentNode = GetNodeObjAsK2PostIt();
+
+	if (!CommentNode)
+	{
+		return;
+	}
+
+	const float ReleaseDelay = UK2PostItProjectSettings::GetOffscreenBodyReleaseDelay();
+
+	if (ReleaseDelay > 0.0f && !OffscreenBodyTicker.IsValid())
+	{
+		OffscreenBodyTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &SGraphNode_K2PostIt::ReleaseOffscreenBody), ReleaseDelay);
+	}
+
+	// An edit usually changes one block, the list keeps the widgets of all the others
+	FormattedTextPanel->SetBlocks(GetBlockKeys());
+
+	StoreMeasuredHeight();
+
+	// Only the blocks at the top have widgets until the list is laid out and the view pushed again
+	FK2PostItGraphViewTracker::Refresh(SharedThis(this));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+TArray<uint64> SGraphNode_K2PostIt::GetBlockKeys() const
+{
+	TArray<uint64> Keys;
+
+	const UEdGraphNode_K2PostIt* CommentNode = GetNodeObjAsK2PostIt();
+
+	if (!CommentNode)
+	{
+		return Keys;
+	}
+
+	const FK2PostItDocument& Document = CommentNode->GetBlocks();
+
+	Keys.Reserve(Document.Num());
+
+	for (const FK2PostItBlockView Block : Document)
+	{
+		Keys.Add(K2PostIt::BlockWidgets::GetBlockKey(Block));
+	}
+
+	return Keys;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+TSharedRef<SWidget> SGraphNode_K2PostIt::GenerateBlockWidget(int32 Index)
+{
+	const UEdGraphNode_K2PostIt* CommentNode = GetNodeObjAsK2PostIt();
+
+	if (!CommentNode || Index < 0 || Index >= CommentNode->GetBlocks().Num())
+	{
+		return SNullWidget::NullWidget;
+	}
+
+	return K2PostIt::BlockWidgets::DrawBlock(CommentNode->GetBlocks().GetBlock(Index), RenderContext.ToSharedRef());
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float SGraphNode_K2PostIt::EstimateBlockHeight(int32 Index) const
+{
+	const UEdGraphNode_K2PostIt* CommentNode = GetNodeObjAsK2PostIt();
+
+	if (!CommentNode || Index < 0 || Index >= CommentNode->GetBlocks().Num())
+	{
+		return 0.0f;
+	}
+
+	return K2PostIt::BlockWidgets::EstimateBlockHeight(CommentNode->GetBlocks().GetBlock(Index), RenderContext->GetWrapAt());
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::RebuildOutline()
+{
+	bOutlineDirty = false;
+
+	OutlinePanel->ClearChildren();
+
+	const UEdGraphNode_K2PostIt* CommentNode = GetNodeObjAsK2PostIt();
+
+	if (!CommentNode)
+	{
+		return;
+	}
+
+	static const FName HeaderStyles[] { "K2PostIt.Header1", "K2PostIt.Header2", "K2PostIt.Header3" };
+
+	for (const FK2PostItBlockView Block : CommentNode->GetBlocks())
+	{
+		if (Block.GetType() != EK2PostItBlockType::Text)
+		{
+			continue;
+		}
+
+		for (const FK2PostItSpanRecord& Span : Block.GetSpans())
+		{
+			if (Span.Type != EK2PostItSpanType::Header1 && Span.Type != EK2PostItSpanType::Header2 && Span.Type != EK2PostItSpanType::Header3)
+			{
+				continue;
+			}
+
+			OutlinePanel->AddSlot()
+			.AutoHeight()
+			[
+				SNew(STextBlock)
+				.TextStyle(FK2PostItStyle::Get(), HeaderStyles[static_cast<uint8>(Span.Type) - static_cast<uint8>(EK2PostItSpanType::Header1)])
+				.Text(FText::FromStringView(Block.GetSpanText(Span)))
+			];
 
-FReply SGraphNode_K2PostIt::OnDrop( const FGeometry& MyGeometry, const FDragDropEvent& DragDropEvent )
-{
-	return FReply::Unhandled();
+			break;
+		}
+	}
 }
 
 // ------------------------------------------------------------------------------------------------
 
-void SGraphNode_K2PostIt::OnDragEnter( const FGeometry& MyGeometry, const FDragDropEvent& DragDropEvent )
+bool SGraphNode_K2PostIt::ReleaseOffscreenBody(float DeltaTime)
 {
+	if (bOnScreen || FPlatformTime::Seconds() - OffScreenSince < UK2PostItProjectSettings::GetOffscreenBodyReleaseDelay())
+	{
+		return true;
+	}
 
-}
+	const UEdGraphNode_K2PostIt* CommentNode = GetNodeObjAsK2PostIt();
 
-// ------------------------------------------------------------------------------------------------
+	// Without a measured height the node could not be culled correctly
+	if (!CommentNode || CommentNode->GetMeasuredHeight(FMath::RoundToInt32(CachedWidth)) <= 0.0f)
+	{
+		return true;
+	}
 
-float SGraphNode_K2PostIt::GetWrapAt() const
-{
-	return CachedWidth - 32.0f;
+	ReleaseBlockWidgets();
+	bRichTextDeferred = true;
+	Invalidate(EInvalidateWidgetReason::Layout);
+
+	OffscreenBodyTicker.Reset();
+	return false;
 }
 
 // ------------------------------------------------------------------------------------------------
 
-FSlateColor SGraphNode_K2PostIt::ForegroundColor_TitleBorder() const
+void SGraphNode_K2PostIt::ReleaseBlockWidgets()
 {
-	FLinearColor Color = K2PostItColor::Error;
-
-	const UEdGraphNode_K2PostIt* Owner = GetNodeObjAsK2PostIt();
-						
-	if (IsValid(Owner))
+	if (FormattedTextPanel.IsValid())
 	{
-		Color = K2PostItColor::GetNominalFontColor(Owner->CommentColor, K2PostItColor::White, K2PostItColor::Noir);
+		FormattedTextPanel->Reset();
 	}
-						
-	return Color;
 }
 
 // ------------------------------------------------------------------------------------------------
 
-FMargin SGraphNode_K2PostIt::Padding_MarkdownPreviewPanel() const
+void SGraphNode_K2PostIt::ShowQuickColorPalette()
 {
-	float MainPanelWidth = MainPanel->GetCachedGeometry().Size.X;
-
-	const float InnerBorderPadding = K2PostIt::Constants::PreviewPanelPadding;
-	const float Gap = K2PostIt::Constants::PreviewPanelGapToEditPanel;
-	
-	return FMargin(MainPanelWidth + Gap, 0, -MainPanelWidth - Gap - InnerBorderPadding, -9999);
-}
+	if (bQuickColorPaletteShown)
+	{
+		return;
+	}
 
-// ------------------------------------------------------------------------------------------------
+	const TArray<FLinearColor> Colors = UK2PostItProjectSettings::GetQuickColorPaletteColors();
 
-void SGraphNode_K2PostIt::RebuildRichText()
-{
-	UE_LOG(LogTemp, VeryVerbose, TEXT("RebuildRichText"));
-	if (UEdGraphNode_K2PostIt* CommentNode = GetNodeObjAsK2PostIt())
+	// The palette is kept between edits, and only rebuilt if the project's palette changed since
+	if (!QuickColorPalette.IsValid() || Colors != QuickColorPaletteColors)
 	{
-		FormattedTextPanel->ClearChildren();
-
-		// This is a bit ugly, I would rather this be const and some other way to inject this widget into the draw setup but
-		for (TInstancedStruct<FK2PostIt_BaseBlock>& Block : CommentNode->GetBlocks())
-		{
-			Block.GetMutable<FK2PostIt_BaseBlock>().SetParentWidget(SharedThis(this));
-		
-			FormattedTextPanel->AddSlot()
-			.AutoHeight()
-			[
-				Block.GetPtr<FK2PostIt_BaseBlock>()->Draw().ToSharedRef()
-			];
-		}
+		QuickColorPalette = BuildQuickColorPalette(Colors);
+		QuickColorPaletteColors = Colors;
 	}
+
+	TitleWidgetPanel->AddSlot()
+	.HAlign(HAlign_Right)
+	.VAlign(VAlign_Top)
+	.Padding(0, -44, 0, 0)
+	[
+		QuickColorPalette.ToSharedRef()
+	];
+
+	bQuickColorPaletteShown = true;
 }
 
 // ------------------------------------------------------------------------------------------------
 
-void SGraphNode_K2PostIt::ShowQuickColorPalette()
+TSharedRef<SWidget> SGraphNode_K2PostIt::BuildQuickColorPalette(const TArray<FLinearColor>& Colors)
 {
-	const TArray<FLinearColor>& Colors = UK2PostItProjectSettings::GetQuickColorPaletteColors();
-	
 	TSharedRef<SHorizontalBox> NewPalette = SNew(SHorizontalBox);
 
 	for (const FLinearColor Color : Colors)
@@ -321,24 +831,17 @@ void SGraphNode_K2PostIt::ShowQuickColorPalette()
 		];
 	}
 
-	QuickColorPalette = NewPalette;
-
-	TitleWidgetPanel->AddSlot()
-	.HAlign(HAlign_Right)
-	.VAlign(VAlign_Top)
-	.Padding(0, -44, 0, 0)
-	[
-		QuickColorPalette.ToSharedRef()
-	];
+	return NewPalette;
 }
 
 // ------------------------------------------------------------------------------------------------
 
 void SGraphNode_K2PostIt::HideQuickColorPalette()
 {
-	if (QuickColorPalette.IsValid())
+	if (bQuickColorPaletteShown)
 	{
 		TitleWidgetPanel->RemoveSlot(QuickColorPalette.ToSharedRef());
+		bQuickColorPaletteShown = false;
 	}
 }
 
@@ -355,6 +858,8 @@ FReply SGraphNode_K2PostIt::OnClicked_QuickColorPaletteColor(const FLinearColor
 
 		Node->CommentColor = NewColor;
 
+		UpdateRenderContext();
+
 		return FReply::Handled();
 	}
 
@@ -385,29 +890,11 @@ FReply SGraphNode_K2PostIt::OnClicked_EditIcon()
 	UEdGraphNode* Node = GetNodeObj();
 	Node->GetGraph()->SelectNodeSet( {Node} );
 
-	TSharedRef<SWindow_K2PostIt> NewPreviewPanelWindow = SNew(SWindow_K2PostIt)
-	.CreateTitleBar(false)
-	.InitialOpacity(0.0)
-	.SizingRule(ESizingRule::Autosized)
-	.LayoutBorder(.0f)
-	[
-		SNew(SBox)
-		.WidthOverride(120.0f)
-		[
-			SNew(SBorder)
-			.BorderImage( FK2PostItStyle::GetImageBrush(K2PostItBrushes.PreviewPaneBorder))
-			.ColorAndOpacity( FLinearColor::White )
-			.BorderBackgroundColor( this, &SGraphNode_K2PostIt::GetMarkdownPreviewPaneColor )
-			.Padding(8)
-			[
-				FormattedTextPanel.ToSharedRef()
-			]
-		]
-	];
+	BuildCommentTextSource();
 
 	PreviewPanelRenderOpacity = -0.1f;
-	PreviewPanelBox->SetContent(NewPreviewPanelWindow);
-	PreviewPanelWindow = NewPreviewPanelWindow;
+	AttachPreviewPanel();
+	StartPreviewPanelAnimation();
 
 	ShowQuickColorPalette();
 
@@ -431,10 +918,86 @@ FReply SGraphNode_K2PostIt::OnClicked_EditIcon()
 
 // ------------------------------------------------------------------------------------------------
 
+void SGraphNode_K2PostIt::AttachPreviewPanel()
+{
+	const TSharedPtr<SGraphPanel> OwnerPanel = GetOwnerPanel();
+
+	if (!OwnerPanel.IsValid())
+	{
+		return;
+	}
+
+	K2PostIt::PreviewPanel::FSharedPreviewPanel& PreviewPanel = K2PostIt::PreviewPanel::Get(OwnerPanel.ToSharedRef());
+
+	if (TSharedPtr<SGraphNode_K2PostIt> PreviousOwner = PreviewPanel.Owner.Pin())
+	{
+		if (PreviousOwner.Get() != this)
+		{
+			PreviousOwner->DetachPreviewPanel();
+		}
+	}
+
+	PreviewPanel.Owner = SharedThis(this);
+	PreviewPanel.Border->SetBorderBackgroundColor(TAttribute<FSlateColor>::CreateSP(this, &SGraphNode_K2PostIt::GetMarkdownPreviewPaneColor));
+	if (!PreviewTextPanel.IsValid())
+	{
+		SAssignNew(PreviewTextPanel, SK2PostItBlockList)
+		.OnGenerateBlock(this, &SGraphNode_K2PostIt::GenerateBlockWidget)
+		.OnReleaseBlock_Static(&K2PostIt::BlockWidgets::ReleaseBlock)
+		.OnEstimateBlockHeight(this, &SGraphNode_K2PostIt::EstimateBlockHeight);
+
+		// The preview is not culled with the graph, the whole comment is built
+		PreviewTextPanel->SetVisibleRange(0.0f, TNumericLimits<float>::Max());
+		PreviewTextPanel->SetBlocks(GetBlockKeys());
+	}
+
+	PreviewPanel.Border->SetContent(PreviewTextPanel.ToSharedRef());
+	PreviewPanel.Window->SetRenderOpacity(0.0f);
+
+	PreviewPanelBox->SetContent(PreviewPanel.Window.ToSharedRef());
+	PreviewPanelWindow = PreviewPanel.Window;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::DetachPreviewPanel()
+{
+	if (!PreviewPanelWindow.IsValid())
+	{
+		return;
+	}
+
+	K2PostIt::PreviewPanel::FSharedPreviewPanel* PreviewPanel = K2PostIt::PreviewPanel::Find(GetOwnerPanel().Get());
+
+	if (PreviewPanel && PreviewPanel->Window.IsValid() && PreviewPanel->Owner.Pin().Get() == this)
+	{
+		PreviewPanel->Border->SetContent(SNullWidget::NullWidget);
+		PreviewPanel->Border->SetBorderBackgroundColor(FSlateColor(FLinearColor::Transparent));
+		PreviewPanel->Owner.Reset();
+	}
+
+	if (PreviewTextPanel.IsValid())
+	{
+		PreviewTextPanel->Reset();
+		PreviewTextPanel.Reset();
+	}
+
+	if (PreviewPanelBox.IsValid())
+	{
+		PreviewPanelBox->SetContent(SNullWidget::NullWidget);
+	}
+
+	PreviewPanelWindow.Reset();
+	PreviewPanelRenderOpacity = 0.0f;
+}
+
+// ------------------------------------------------------------------------------------------------
+
 int32 SGraphNode_K2PostIt::WidgetIndex_CommentTextPane() const
 {
 	const int32 EditMode = 0;
 	const int32 MarkupMode = 1;
+	const int32 OutlineMode = 2;
 
 	/*
 	if (bTitleWidgetPanelFocused)
@@ -443,31 +1006,68 @@ int32 SGraphNode_K2PostIt::WidgetIndex_CommentTextPane() const
 	}
 	*/
 	
-	if (UK2PostItProjectSettings::GetMarkdownDisabledByDefault())
-	{
-		if (!GetNodeObjAsK2PostIt()->bEnableMarkdownRendering)
-		{
-			return EditMode;
-		}
-	}
-	else
+	if (IsMarkdownDisabled())
 	{
-		if (GetNodeObjAsK2PostIt()->bDisableMarkdownRendering)
-		{
-			return EditMode;
-		}
+		return EditMode;
 	}
 	
-	if ((bEditButtonClicked && bIsSelected) || CommentTextSource->HasKeyboardFocus())
+	if ((bEditButtonClicked && bIsSelected) || (CommentTextSource.IsValid() && CommentTextSource->HasKeyboardFocus()))
 	{
 		return EditMode;
 	}
+
+	if (CachedBodyDetail == EBodyDetail::Outline)
+	{
+		return OutlineMode;
+	}
 	
 	return MarkupMode;
 }
 
 // ------------------------------------------------------------------------------------------------
 
+bool SGraphNode_K2PostIt::IsMarkdownDisabled() const
+{
+	if (UK2PostItProjectSettings::GetMarkdownDisabledByDefault())
+	{
+		return !GetNodeObjAsK2PostIt()->bEnableMarkdownRendering;
+	}
+
+	return GetNodeObjAsK2PostIt()->bDisableMarkdownRendering;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 SGraphNode_K2PostIt::WidgetIndex_NodeBody() const
+{
+	const int32 NodeMode = 0;
+	const int32 CardMode = 1;
+
+	return CachedBodyDetail == EBodyDetail::Card ? CardMode : NodeMode;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+SGraphNode_K2PostIt::EBodyDetail SGraphNode_K2PostIt::ComputeBodyDetail() const
+{
+	// EK2PostItZoomDetail lists the graph LODs from the furthest out, after Never
+	const int32 ZoomDetail = static_cast<int32>(GetCurrentLOD()) + 1;
+
+	if (ZoomDetail <= static_cast<int32>(UK2PostItProjectSettings::GetCardZoomDetail()))
+	{
+		return EBodyDetail::Card;
+	}
+
+	if (ZoomDetail <= static_cast<int32>(UK2PostItProjectSettings::GetOutlineZoomDetail()))
+	{
+		return EBodyDetail::Outline;
+	}
+
+	return EBodyDetail::Full;
+}
+
+// ------------------------------------------------------------------------------------------------
+
 void SGraphNode_K2PostIt::UpdatePreviewPanelOpacity()
 {
 	if (PreviewPanelWindow.IsValid())
@@ -475,7 +1075,7 @@ void SGraphNode_K2PostIt::UpdatePreviewPanelOpacity()
 		PreviewPanelWindow.Pin()->SetRenderOpacity(PreviewPanelRenderOpacity);
 
 		PreviewPanelBox->SetWidthOverride(MainPanel->GetCachedGeometry().Size.X);
-		PreviewPanelBox->SetMinDesiredHeight(FormattedTextPanel->GetDesiredSize().Y + 16);
+		PreviewPanelBox->SetMinDesiredHeight(PreviewTextPanel->GetDesiredSize().Y + 16);
 	}
 }
 
@@ -484,6 +1084,9 @@ void SGraphNode_K2PostIt::UpdatePreviewPanelOpacity()
 void SGraphNode_K2PostIt::K2PostIt_OnNameTextCommited(const FText& InText, ETextCommit::Type CommitInfo)
 {
 	OnTextCommitted.ExecuteIfBound(InText, CommitInfo, GraphNode);
+
+	// The title is part of the measured height
+	StoreMeasuredHeight();
 	
 	UpdateErrorInfo();
 	if (ErrorReporting.IsValid())
@@ -544,7 +1147,14 @@ void SGraphNode_K2PostIt::UpdateGraphNode()
 	CommentStyle.EditableTextBoxStyle.TextStyle.Font.Size = CachedFontSize;
 	CommentStyle.TextStyle.Font.Size = CachedFontSize;
 
-	SAssignNew(FormattedTextPanel, SVerticalBox);
+	DetachPreviewPanel();
+	ReleaseBlockWidgets();
+	SAssignNew(FormattedTextPanel, SK2PostItBlockList)
+	.OnGenerateBlock(this, &SGraphNode_K2PostIt::GenerateBlockWidget)
+	.OnReleaseBlock_Static(&K2PostIt::BlockWidgets::ReleaseBlock)
+	.OnEstimateBlockHeight(this, &SGraphNode_K2PostIt::EstimateBlockHeight);
+	SAssignNew(OutlinePanel, SVerticalBox);
+	bOutlineDirty = true;
 
 	TAttribute<FMargin> PaddingAttribute_PreviewPane = TAttribute<FMargin>::CreateRaw(this, &SGraphNode_K2PostIt::Padding_MarkdownPreviewPanel);
 
@@ -553,168 +1163,256 @@ void SGraphNode_K2PostIt::UpdateGraphNode()
 		.HAlign(HAlign_Fill)
 		.VAlign(VAlign_Fill)
 		[
-			SAssignNew(MainPanel, SBorder)
-			.BorderImage( FK2PostItStyle::GetImageBrush(K2PostItBrushes.Border_K2PostItNode))
-			.ColorAndOpacity( FLinearColor::White )
-			.BorderBackgroundColor( this, &SGraphNode_K2PostIt::GetCommentBodyColor )
-			.ForegroundColor(K2PostItColor::DarkGray)
-			.Padding(4.0f, 4.0f, 4.0f, 8.0f)
-			.AddMetaData<FGraphNodeMetaData>(TagMeta)
-			.ToolTip(nullptr)
+			SNew(SWidgetSwitcher)
+			.WidgetIndex(this, &SGraphNode_K2PostIt::WidgetIndex_NodeBody)
+			+ SWidgetSwitcher::Slot()
 			[
-				SNew(SOverlay)
-				+ SOverlay::Slot()
+				SAssignNew(MainPanel, SBorder)
+				.BorderImage( FK2PostItStyle::GetImageBrush(K2PostItBrushes.Border_K2PostItNode))
+				.ColorAndOpacity( FLinearColor::White )
+				.BorderBackgroundColor( this, &SGraphNode_K2PostIt::GetCommentBodyColor )
+				.ForegroundColor(K2PostItColor::DarkGray)
+				.Padding(4.0f, 4.0f, 4.0f, 8.0f)
+				.AddMetaData<FGraphNodeMetaData>(TagMeta)
+				.ToolTip(nullptr)
 				[
-					SNew(SVerticalBox)
-					//.ToolTipText( this, &SGraphNode::GetNodeTooltip )
-					+SVerticalBox::Slot()
-					.AutoHeight()
-					.HAlign(HAlign_Fill)
-					.VAlign(VAlign_Top)
+					SNew(SOverlay)
+					+ SOverlay::Slot()
 					[
-						SAssignNew(TitleBar, SBorder)
-						.BorderImage( FAppStyle::GetBrush("NoBorder") )
-						.BorderBackgroundColor(K2PostItColor::White)
-						.ForegroundColor(this, &SGraphNode_K2PostIt::ForegroundColor_TitleBorder)
-						.Padding( FMargin(8,5,8,3) )
+						SNew(SVerticalBox)
+						//.ToolTipText( this, &SGraphNode::GetNodeTooltip )
+						+SVerticalBox::Slot()
+						.AutoHeight()
 						.HAlign(HAlign_Fill)
-						.VAlign(VAlign_Center)
+						.VAlign(VAlign_Top)
 						[
-							SNew(SVerticalBox)
-							+ SVerticalBox::Slot()
+							SAssignNew(TitleBar, SBorder)
+							.BorderImage( FAppStyle::GetBrush("NoBorder") )
+							.BorderBackgroundColor(K2PostItColor::White)
+							.ForegroundColor(this, &SGraphNode_K2PostIt::ForegroundColor_TitleBorder)
+							.Padding( FMargin(8,5,8,3) )
+							.HAlign(HAlign_Fill)
+							.VAlign(VAlign_Center)
 							[
+								SNew(SVerticalBox)
+								+ SVerticalBox::Slot()
+								[
 							
-								SAssignNew(TitleWidgetPanel, SOverlay)
-								+ SOverlay::Slot()
+									SAssignNew(TitleWidgetPanel, SOverlay)
+									+ SOverlay::Slot()
+									[
+										SAssignNew(InlineEditableText, SK2PostItTitleTextBlock)
+										.Style( &CommentStyle )
+										.ColorAndOpacity(this, &SGraphNode_K2PostIt::ColorAndOpacity_TitleText)
+										.ShadowOffset(0)
+										.ShadowColorAndOpacity(K2PostItColor::Transparent)
+										.Text( this, &SGraphNode_K2PostIt::GetEditableNodeTitleAsText )
+										.EmptyText(LOCTEXT("K2PostIt_CommentTitleDefaultText", "Comment"))
+										.OnVerifyTextChanged(this, &SGraphNode_K2PostIt::OnVerifyNameTextChanged)
+										.OnTextCommitted(this, &SGraphNode_K2PostIt::K2PostIt_OnNameTextCommited)
+										.IsReadOnly( this, &SGraphNode_K2PostIt::IsNameReadOnly )
+										.IsSelected( this, &SGraphNode_K2PostIt::IsSelectedExclusively )
+										.WrapTextAt( this, &SGraphNode_K2PostIt::GetWrapAt )
+										.MultiLine(true)
+										.ModiferKeyForNewLine(EModifierKey::Shift)	
+									]	
+								]
+								+ SVerticalBox::Slot()
+								.AutoHeight()
+								.Padding(0.0f, 2.0f)
 								[
-									SAssignNew(InlineEditableText, SK2PostItTitleTextBlock)
-									.Style( &CommentStyle )
-									.ColorAndOpacity(this, &SGraphNode_K2PostIt::ColorAndOpacity_TitleText)
-									.ShadowOffset(0)
-									.ShadowColorAndOpacity(K2PostItColor::Transparent)
-									.Text( this, &SGraphNode_K2PostIt::GetEditableNodeTitleAsText )
-									.EmptyText(LOCTEXT("K2PostIt_CommentTitleDefaultText", "Comment"))
-									.OnVerifyTextChanged(this, &SGraphNode_K2PostIt::OnVerifyNameTextChanged)
-									.OnTextCommitted(this, &SGraphNode_K2PostIt::K2PostIt_OnNameTextCommited)
-									.IsReadOnly( this, &SGraphNode_K2PostIt::IsNameReadOnly )
-									.IsSelected( this, &SGraphNode_K2PostIt::IsSelectedExclusively )
-									.WrapTextAt( this, &SGraphNode_K2PostIt::GetWrapAt )
-									.MultiLine(true)
-									.ModiferKeyForNewLine(EModifierKey::Shift)	
-								]	
-							]
-							+ SVerticalBox::Slot()
-							.AutoHeight()
-							.Padding(0.0f, 2.0f)
-							[
-								SNew(SSeparator)
-								.Thickness(2)
-								.ColorAndOpacity(K2PostItColor::DarkGray_Trans)
+									SNew(SSeparator)
+									.Thickness(2)
+									.ColorAndOpacity(K2PostItColor::DarkGray_Trans)
+								]
 							]
 						]
-					]
-					+SVerticalBox::Slot()
-					.AutoHeight()
-					.Padding(1.0f)
-					[
-						ErrorReporting->AsWidget()
-					]
-					+ SVerticalBox::Slot()
-					.HAlign(HAlign_Fill)
-					.VAlign(VAlign_Fill)
-					[
-						SNew(SBox)
-						.MinDesiredHeight(33)
+						+SVerticalBox::Slot()
+						.AutoHeight()
+						.Padding(1.0f)
+						[
+							ErrorReporting->AsWidget()
+						]
+						+ SVerticalBox::Slot()
+						.HAlign(HAlign_Fill)
+						.VAlign(VAlign_Fill)
 						[
-							SNew(SOverlay)
-							+ SOverlay::Slot()
+							SNew(SBox)
+							.MinDesiredHeight(33)
 							[
-									
-								SNew(SWidgetSwitcher)
-								.WidgetIndex(this, &SGraphNode_K2PostIt::WidgetIndex_CommentTextPane)
-								+ SWidgetSwitcher::Slot()
-								.HAlign(HAlign_Fill)
-								.VAlign(VAlign_Fill)
+								SNew(SOverlay)
+								+ SOverlay::Slot()
 								[
-									SNew(SOverlay)
-									+ SOverlay::Slot()
+									
+									SNew(SWidgetSwitcher)
+									.WidgetIndex(this, &SGraphNode_K2PostIt::WidgetIndex_CommentTextPane)
+									+ SWidgetSwitcher::Slot()
+									.HAlign(HAlign_Fill)
+									.VAlign(VAlign_Fill)
+									[
+										SNew(SOverlay)
+										+ SOverlay::Slot()
+										[
+											SNew(SBorder)
+											.BorderImage( FAppStyle::GetBrush("NoBorder") )
+											.ForegroundColor(this, &SGraphNode_K2PostIt::ForegroundColor_TitleBorder)
+											.VAlign(VAlign_Fill)
+											.Padding(7, 8, 7, 8)
+											[
+												// Filled by BuildCommentTextSource, most comments are never edited
+												SAssignNew(CommentTextSourceBox, SBox)
+											]
+										]
+									]
+									+ SWidgetSwitcher::Slot()
+									.Padding(8)
+									.HAlign(HAlign_Fill)
+									.VAlign(VAlign_Fill)
+									[
+										// Comment bodies rarely change, so their draw elements are cached until one of the block widgets does
+										SNew(SInvalidationPanel)
+										[
+											FormattedTextPanel.ToSharedRef()
+										]
+									]
+									+ SWidgetSwitcher::Slot()
+									.Padding(8)
+									.HAlign(HAlign_Fill)
+									.VAlign(VAlign_Top)
 									[
 										SNew(SBorder)
 										.BorderImage( FAppStyle::GetBrush("NoBorder") )
-										.ForegroundColor_Lambda( [this] ()
-										{
-											FLinearColor Color = K2PostItColor::Error;
-
-											UEdGraphNode_K2PostIt* Owner = GetNodeObjAsK2PostIt();
-											
-											if (IsValid(Owner))
-											{
-												Color = K2PostItColor::GetNominalFontColor(Owner->CommentColor, K2PostItColor::White, K2PostItColor::Noir);
-											}
-											
-											return Color;
-										})
-										.VAlign(VAlign_Fill)
-										.Padding(7, 8, 7, 8)
+										.ForegroundColor(this, &SGraphNode_K2PostIt::ForegroundColor_TitleBorder)
+										.Padding(0)
 										[
-											SAssignNew(CommentTextSource, SMultiLineEditableTextBox)
-											//.TextStyle(FK2PostItStyle::Get(), K2PostItStyles.TextStyle_Editor)
-											.Style(FK2PostItStyle::Get(), K2PostItStyles.TextBoxStyle_CommentEditor)
-											.Text(this, &SGraphNode_K2PostIt::Text_CommentTextSource)
-											.OnTextChanged(this, &SGraphNode_K2PostIt::OnTextChanged_CommentTextSource)
-											.OnTextCommitted(this, &SGraphNode_K2PostIt::OnTextCommitted_CommentTextSource)
-											.RevertTextOnEscape(true)
-											.WrapTextAt( this, &SGraphNode_K2PostIt::GetWrapAt )
+											OutlinePanel.ToSharedRef()
 										]
 									]
 								]
-								+ SWidgetSwitcher::Slot()
-								.Padding(8)
-								.HAlign(HAlign_Fill)
-								.VAlign(VAlign_Fill)
+								+ SOverlay::Slot()
+								.HAlign(HAlign_Left)
+								.VAlign(VAlign_Top)
+								.Padding(PaddingAttribute_PreviewPane)
 								[
-									FormattedTextPanel.ToSharedRef()
+									SAssignNew(PreviewPanelBox, SBox)
+									.Visibility(EVisibility::SelfHitTestInvisible)
 								]
 							]
-							+ SOverlay::Slot()
-							.HAlign(HAlign_Left)
-							.VAlign(VAlign_Top)
-							.Padding(PaddingAttribute_PreviewPane)
-							[
-								SAssignNew(PreviewPanelBox, SBox)
-								.Visibility(EVisibility::SelfHitTestInvisible)
-							]
 						]
 					]
-				]
-				+ SOverlay::Slot()
-				.HAlign(HAlign_Right)
-				.VAlign(VAlign_Top)
-				.Padding(0, 0, 0, 0)
-				[
-					SNew(SButton)
-					.ButtonStyle(FK2PostItStyle::Get(), K2PostItStyles.ButtonStyle_EditButton)
-					.ContentPadding(0)
-					.OnClicked(this, &SGraphNode_K2PostIt::OnClicked_EditIcon)
-					.Visibility(this, &SGraphNode_K2PostIt::Visibility_EditButton)
-					.Cursor(EMouseCursor::Default)
+					+ SOverlay::Slot()
+					.HAlign(HAlign_Right)
+					.VAlign(VAlign_Top)
+					.Padding(0, 0, 0, 0)
 					[
-						SNew(SBorder)
-						.BorderImage(FAppStyle::GetBrush("Icons.FilledCircle"))
-						.BorderBackgroundColor(K2PostItColor::DarkGray_Glass)
-						.Padding(8)
-						[
-							SNew(SImage)
-							.Image(FK2PostItStyle::GetImageBrush(K2PostItBrushes.Icon_Edit))
-							.DesiredSizeOverride(FVector2D(16))
-							.ColorAndOpacity(FSlateColor::UseForeground())
-						]
+						// Filled by BuildEditButton when the node is first hovered
+						SAssignNew(EditButtonBox, SBox)
 					]
 				]
 			]
+			// Zoomed far out only the node's color and title can be made out, so that is all that is drawn
+			+ SWidgetSwitcher::Slot()
+			[
+				SNew(SBorder)
+				.BorderImage( FK2PostItStyle::GetImageBrush(K2PostItBrushes.Border_K2PostItNode))
+				.BorderBackgroundColor( this, &SGraphNode_K2PostIt::GetCommentBodyColor )
+				.ForegroundColor(this, &SGraphNode_K2PostIt::ForegroundColor_TitleBorder)
+				.Padding( FMargin(12,9,12,3) )
+				[
+					SNew(STextBlock)
+					.Font(CommentStyle.TextStyle.Font)
+					.ColorAndOpacity(FSlateColor::UseForeground())
+					.Text( this, &SGraphNode_K2PostIt::GetEditableNodeTitleAsText )
+					.WrapTextAt( this, &SGraphNode_K2PostIt::GetWrapAt )
+				]
+			]
 		];
 
-	// Create comment bubble
+	// The old palette went with the old title panel
+	QuickColorPalette.Reset();
+	bQuickColorPaletteShown = false;
+
+	// The body editor, the comment bubble and the edit button are built on first use by the Build functions below
+	CommentTextSource.Reset();
+	EditButton.Reset();
+
+	if (IsMarkdownDisabled())
+	{
+		BuildCommentTextSource();
+	}
+
+	// Knowing the height is enough to cull the node correctly, so the markdown widgets can wait until it is first drawn
+	if (GetNodeObjAsK2PostIt()->GetMeasuredHeight(FMath::RoundToInt32(CachedWidth)) > 0.0f)
+	{
+		bRichTextDeferred = true;
+	}
+	else
+	{
+		RebuildRichText();
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::BuildCommentTextSource()
+{
+	if (CommentTextSource.IsValid())
+	{
+		return;
+	}
+
+	CommentTextSourceBox->SetContent(
+		SAssignNew(CommentTextSource, SMultiLineEditableTextBox)
+		//.TextStyle(FK2PostItStyle::Get(), K2PostItStyles.TextStyle_Editor)
+		.Style(FK2PostItStyle::Get(), K2PostItStyles.TextBoxStyle_CommentEditor)
+		.Text(this, &SGraphNode_K2PostIt::Text_CommentTextSource)
+		.OnTextChanged(this, &SGraphNode_K2PostIt::OnTextChanged_CommentTextSource)
+		.OnTextCommitted(this, &SGraphNode_K2PostIt::OnTextCommitted_CommentTextSource)
+		.RevertTextOnEscape(true)
+		.WrapTextAt( this, &SGraphNode_K2PostIt::GetWrapAt )
+	);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::BuildEditButton()
+{
+	if (EditButton.IsValid())
+	{
+		return;
+	}
+
+	EditButtonBox->SetContent(
+		SAssignNew(EditButton, SButton)
+		.ButtonStyle(FK2PostItStyle::Get(), K2PostItStyles.ButtonStyle_EditButton)
+		.ContentPadding(0)
+		.OnClicked(this, &SGraphNode_K2PostIt::OnClicked_EditIcon)
+		.Visibility(this, &SGraphNode_K2PostIt::Visibility_EditButton)
+		.Cursor(EMouseCursor::Default)
+		[
+			SNew(SBorder)
+			.BorderImage(FAppStyle::GetBrush("Icons.FilledCircle"))
+			.BorderBackgroundColor(K2PostItColor::DarkGray_Glass)
+			.Padding(8)
+			[
+				SNew(SImage)
+				.Image(FK2PostItStyle::GetImageBrush(K2PostItBrushes.Icon_Edit))
+				.DesiredSizeOverride(FVector2D(16))
+				.ColorAndOpacity(FSlateColor::UseForeground())
+			]
+		]
+	);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SGraphNode_K2PostIt::BuildCommentBubble()
+{
+	if (CommentBubble.IsValid())
+	{
+		return;
+	}
+
 	CommentBubble = SNew(SCommentBubble)
 	.GraphNode(GraphNode)
 	.Text(this, &SGraphNode_K2PostIt::GetNodeComment)
@@ -735,8 +1433,6 @@ void SGraphNode_K2PostIt::UpdateGraphNode()
 	[
 		CommentBubble.ToSharedRef()
 	];
-
-	RebuildRichText();
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -745,6 +1441,14 @@ FVector2D SGraphNode_K2PostIt::ComputeDesiredSize( float ) const
 {
 	//float Height = TitleBar->GetDesiredSize().Y + ErrorReporting->AsWidget()->GetDesiredSize().Y + FormattedTextPanel->GetDesiredSize().Y;
 	float Height = MainPanel->GetDesiredSize().Y;
+
+	const UEdGraphNode_K2PostIt* CommentNode = GetNodeObjAsK2PostIt();
+
+	// While only the outline or the card is drawn the node keeps the size of its full body, as native comments do
+	if ((bRichTextDeferred || CachedBodyDetail != EBodyDetail::Full) && CommentNode)
+	{
+		Height = FMath::Max(Height, CommentNode->GetMeasuredHeight(FMath::RoundToInt32(CachedWidth)));
+	}
 	
 	return FVector2D(UserSize.X, Height);
 }
@@ -840,8 +1544,6 @@ void SGraphNode_K2PostIt::HandleSelection(bool bSelected, bool bUpdateNodesUnder
 
 const FSlateBrush* SGraphNode_K2PostIt::GetShadowBrush(bool bSelected) const
 {
-	HandleSelection(bSelected);
-	
 	return bSelected
 		? FK2PostItStyle::GetImageBrush(K2PostItBrushes.SelectionShadow_K2PostItNode)
 		: FK2PostItStyle::GetImageBrush(K2PostItBrushes.Shadow_K2PostItNode);
@@ -872,11 +1574,15 @@ void SGraphNode_K2PostIt::GetOverlayBrushes(bool bSelected, const FVector2D Widg
 void SGraphNode_K2PostIt::MoveTo( const FVector2D& NewPosition, FNodeSet& NodeFilter, bool bMarkDirty)
 {
 	SGraphNode::MoveTo(NewPosition, NodeFilter, bMarkDirty);
+
+	FK2PostItGraphViewTracker::Refresh(SharedThis(this));
 }
 #else
 void SGraphNode_K2PostIt::MoveTo( const FVector2f& NewPosition, FNodeSet& NodeFilter, bool bMarkDirty)
 {
 	SGraphNode::MoveTo(NewPosition, NodeFilter, bMarkDirty);
+
+	FK2PostItGraphViewTracker::Refresh(SharedThis(this));
 }
 #endif
 
@@ -945,36 +1651,14 @@ FVector2D SGraphNode_K2PostIt::GetNodeMaximumSize() const
 
 FSlateColor SGraphNode_K2PostIt::GetCommentBodyColor() const
 {
-	if (UEdGraphNode_K2PostIt* CommentNode = Cast<UEdGraphNode_K2PostIt>(GraphNode))
-	{
-		return CommentNode->CommentColor;
-	}
-
-	return FLinearColor::White;
+	return RenderContext->GetCommentColor();
 }
 
 // ------------------------------------------------------------------------------------------------
 
 FSlateColor SGraphNode_K2PostIt::GetMarkdownPreviewPaneColor() const
 {
-	UEdGraphNode_K2PostIt* CommentNode = Cast<UEdGraphNode_K2PostIt>(GraphNode);
-
-	FLinearColor Color;
-	
-	if (CommentNode)
-	{
-		Color = CommentNode->CommentColor;
-	}
-	else
-	{
-		Color = FLinearColor::White;
-	}
-
-	Color = K2PostItColor::Desaturate(Color, 0.1f);
-	Color = K2PostItColor::Darken(Color, 0.9f);
-	Color.A *= 0.8f;
-
-	return Color;
+	return RenderContext->GetTheme().PreviewPaneColor;
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -1022,7 +1706,7 @@ FText SGraphNode_K2PostIt::Text_CommentTextSource() const
 {
 	if (UEdGraphNode_K2PostIt* CommentNode = Cast<UEdGraphNode_K2PostIt>(GraphNode))
 	{
-		return CommentNode->CommentText;
+		return CommentNode->GetCommentText();
 	}
 
 	return FText::GetEmpty();
@@ -1132,12 +1816,7 @@ FSlateColor SGraphNode_K2PostIt::ColorAndOpacity_TitleText() const
 		// TODO this should compare localized text
 		if (TitleText.IsEmpty())//|| TitleText.ToString() == "Comment")
 		{
-			if (const UEdGraphNode_K2PostIt* Node = GetNodeObjAsK2PostIt())
-			{
-				return K2PostItColor::GetNominalFontColor(Node->CommentColor, K2PostItColor::Gray, K2PostItColor::Gray);				
-			}
-
-			return K2PostItColor::Gray_SemiTrans;
+			return RenderContext->GetTheme().EmptyTitleColor;
 		}
 	}
 	
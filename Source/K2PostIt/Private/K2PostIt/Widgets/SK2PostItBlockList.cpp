@@ -0,0 +1,272 @@
+// Unlicensed. This file is public domain.
+
+#include "K2PostIt/Widgets/SK2PostItBlockList.h"
+
+#include "Containers/Map.h"
+#include "K2PostIt/Globals/K2PostItConstants.h"
+#include "Layout/ArrangedChildren.h"
+#include "Layout/Geometry.h"
+#include "Widgets/SNullWidget.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+SK2PostItBlockList::SK2PostItBlockList()
+	: Children(this)
+	, VisibleBottom(K2PostIt::Constants::BlockList_InitialVisibleHeight)
+{
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SK2PostItBlockList::Construct(const FArguments& InArgs)
+{
+	OnGenerateBlock = InArgs._OnGenerateBlock;
+	OnReleaseBlock = InArgs._OnReleaseBlock;
+	OnEstimateBlockHeight = InArgs._OnEstimateBlockHeight;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SK2PostItBlockList::SetBlocks(TConstArrayView<uint64> Keys)
+{
+	// Blocks can move around in an edit, so they are matched by key rather than by position
+	TMultiMap<uint64, int32> OldIndices;
+
+	for (int32 Index = 0; Index < Blocks.Num(); ++Index)
+	{
+		OldIndices.Add(Blocks[Index].Key, Index);
+	}
+
+	TArray<FBlock> NewBlocks;
+	NewBlocks.Reserve(Keys.Num());
+
+	for (int32 Index = 0; Index < Keys.Num(); ++Index)
+	{
+		FBlock& NewBlock = NewBlocks.AddDefaulted_GetRef();
+
+		if (const int32* Found = OldIndices.Find(Keys[Index]))
+		{
+			const int32 OldIndex = *Found;
+			OldIndices.RemoveSingle(Keys[Index], OldIndex);
+
+			NewBlock = MoveTemp(Blocks[OldIndex]);
+		}
+		else
+		{
+			NewBlock.Key = Keys[Index];
+			NewBlock.Height = EstimateHeight(Index);
+		}
+	}
+
+	for (const TPair<uint64, int32>& Unused : OldIndices)
+	{
+		RemoveWidget(Unused.Value);
+	}
+
+	Blocks = MoveTemp(NewBlocks);
+
+	UpdateWidgets();
+	Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SK2PostItBlockList::Reset()
+{
+	for (int32 Index = 0; Index < Blocks.Num(); ++Index)
+	{
+		RemoveWidget(Index);
+	}
+
+	Blocks.Reset();
+	Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SK2PostItBlockList::ResetMeasurements()
+{
+	for (int32 Index = 0; Index < Blocks.Num(); ++Index)
+	{
+		if (!Blocks[Index].Widget.IsValid())
+		{
+			Blocks[Index].Height = EstimateHeight(Index);
+		}
+	}
+
+	bHeightsChanged = true;
+	Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool SK2PostItBlockList::SetVisibleRange(float Top, float Bottom)
+{
+	// The blocks only need walking when the view or their layout moved
+	if (Top == VisibleTop && Bottom == VisibleBottom && !bHeightsChanged)
+	{
+		return false;
+	}
+
+	VisibleTop = Top;
+	VisibleBottom = Bottom;
+
+	return UpdateWidgets();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SK2PostItBlockList::ForEachWidget(TFunctionRef<void(const TSharedRef<SWidget>&)> Callback) const
+{
+	for (const FBlock& Block : Blocks)
+	{
+		if (Block.Widget.IsValid())
+		{
+			Callback(Block.Widget.ToSharedRef());
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SK2PostItBlockList::OnArrangeChildren(const FGeometry& AllottedGeometry, FArrangedChildren& ArrangedChildren) const
+{
+	const float Width = AllottedGeometry.GetLocalSize().X;
+
+	float Top = 0.0f;
+
+	for (const FBlock& Block : Blocks)
+	{
+		if (Block.Widget.IsValid() && ArrangedChildren.Accepts(Block.Widget->GetVisibility()))
+		{
+			ArrangedChildren.AddWidget(AllottedGeometry.MakeChild(Block.Widget.ToSharedRef(), FVector2D(0.0f, Top), FVector2D(Width, Block.Height)));
+		}
+
+		Top += Block.Height;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FVector2D SK2PostItBlockList::ComputeDesiredSize(float) const
+{
+	FVector2D DesiredSize = FVector2D::ZeroVector;
+
+	for (FBlock& Block : Blocks)
+	{
+		if (Block.Widget.IsValid() && Block.Widget->GetVisibility() != EVisibility::Collapsed)
+		{
+			const FVector2D WidgetSize = Block.Widget->GetDesiredSize();
+
+			bHeightsChanged |= Block.Height != WidgetSize.Y;
+			Block.Height = WidgetSize.Y;
+			DesiredSize.X = FMath::Max(DesiredSize.X, WidgetSize.X);
+		}
+
+		DesiredSize.Y += Block.Height;
+	}
+
+	return DesiredSize;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FChildren* SK2PostItBlockList::GetChildren()
+{
+	return &Children;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool SK2PostItBlockList::UpdateWidgets()
+{
+	// Widgets are built a margin ahead of the view and kept until twice that behind it, so panning back and forth does not churn them
+	const float Margin = K2PostIt::Constants::BlockList_VisibleMargin;
+
+	bHeightsChanged = false;
+
+	bool bChanged = false;
+	float Top = 0.0f;
+
+	for (int32 Index = 0; Index < Blocks.Num(); ++Index)
+	{
+		const float Bottom = Top + Blocks[Index].Height;
+
+		if (!Blocks[Index].Widget.IsValid())
+		{
+			if (Bottom >= VisibleTop - Margin && Top <= VisibleBottom + Margin)
+			{
+				AddWidget(Index);
+				bChanged = true;
+			}
+		}
+		else if (Bottom < VisibleTop - 2.0f * Margin || Top > VisibleBottom + 2.0f * Margin)
+		{
+			RemoveWidget(Index);
+			bChanged = true;
+		}
+
+		Top = Bottom;
+	}
+
+	if (bChanged)
+	{
+		Invalidate(EInvalidateWidgetReason::ChildOrder);
+	}
+
+	return bChanged;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SK2PostItBlockList::AddWidget(int32 Index)
+{
+	if (!OnGenerateBlock.IsBound())
+	{
+		return;
+	}
+
+	const TSharedRef<SWidget> Widget = OnGenerateBlock.Execute(Index);
+
+	if (Widget == SNullWidget::NullWidget)
+	{
+		return;
+	}
+
+	Blocks[Index].Widget = Widget;
+	Children.Add(Widget);
+
+	// Measured now rather than at the next layout, so the blocks after it are placed right while the rest of the range is filled
+	Widget->SlatePrepass(GetPrepassLayoutScaleMultiplier());
+	Blocks[Index].Height = Widget->GetDesiredSize().Y;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void SK2PostItBlockList::RemoveWidget(int32 Index)
+{
+	if (!Blocks[Index].Widget.IsValid())
+	{
+		return;
+	}
+
+	const TSharedRef<SWidget> Widget = Blocks[Index].Widget.ToSharedRef();
+
+	Blocks[Index].Widget.Reset();
+	Children.Remove(Widget);
+
+	OnReleaseBlock.ExecuteIfBound(Widget);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float SK2PostItBlockList::EstimateHeight(int32 Index) const
+{
+	return OnEstimateBlockHeight.IsBound() ? OnEstimateBlockHeight.Execute(Index) : K2PostIt::Constants::BlockEstimate_LineHeight;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#undef LOCTEXT_NAMESPACE
@@ -30,6 +30,20 @@ namespace K2PostIt
 		constexpr float BulletIndentFactor = 24.0f;
 		constexpr float BulletSymbolWidth = 16.0f;
 		constexpr float BulletBaseIndent = 8.0f; 
+
+		constexpr int32 ParseCacheMaxEntries = 256;
+
+		constexpr int32 ReparseBatchSize = 16;
+		constexpr float ReparseInterval = 0.05f;
+
+		constexpr int32 BlockWidgetPoolMaxPerType = 128;
+		constexpr float BlockWidgetPoolTrimInterval = 10.0f;
+
+		constexpr float BlockEstimate_LineHeight = 18.0f;
+		constexpr float BlockEstimate_CharWidth = 7.0f;
+
+		constexpr float BlockList_InitialVisibleHeight = 1024.0f;
+		constexpr float BlockList_VisibleMargin = 256.0f;
 	}
 }
 
@@ -2,15 +2,12 @@
 
 #pragma once
 
+#include "K2PostIt/K2PostItDocument.h"
 #include "Runtime/Launch/Resources/Version.h"
-#include "Styling/SlateColor.h"
 #include "Tasks/Task.h"
 
 // ================================================================================================
 
-class SGraphNode_K2PostIt;
-class UEdGraphNode_K2PostIt;
-class SWidget;
 class FRegexMatcher;
 
 #if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION < 5
@@ -21,6 +18,7 @@ class FRegexMatcher;
 
 #include "K2PostItAsyncParser.generated.h"
 
+/** Blocks in this form are only used as the parser's working set and by older assets. Parsed comments are kept as FK2PostItDocument. */
 USTRUCT()
 struct FK2PostIt_BaseBlock
 {
@@ -30,16 +28,6 @@ public:
 	FK2PostIt_BaseBlock() {}
 	
 	virtual ~FK2PostIt_BaseBlock() {}
-	
-	void SetParentWidget(TSharedPtr<SGraphNode_K2PostIt> GraphNodeK2PostIt);
-
-protected:
-	TWeakPtr<SGraphNode_K2PostIt> OwnerWidget;
-
-	UEdGraphNode_K2PostIt* GetOwnerNode() const;
-	
-public:
-	virtual TSharedPtr<SWidget> Draw() const { return nullptr; };
 };
 
 // ================================================================================================
@@ -59,14 +47,9 @@ protected:
 	FString Text;
 
 public:
-	TSharedPtr<SWidget> Draw() const override;
-
 	FString& GetText() { return Text; }
 	
 	const FString& GetText() const { return Text; }
-
-protected:
-	FSlateColor GetForegroundColor() const;
 };
 
 // ================================================================================================
@@ -78,9 +61,6 @@ struct FK2PostIt_SeparatorBlock : public FK2PostIt_BaseBlock
 
 public:
 	FK2PostIt_SeparatorBlock() {};
-
-public:
-	TSharedPtr<SWidget> Draw() const override;
 };
 
 // ================================================================================================
@@ -94,9 +74,6 @@ public:
 	FK2PostIt_CodeBlock() {};
 
 	FK2PostIt_CodeBlock(const FString& InText) : FK2PostIt_TextBlock(InText) { }
-
-public:
-	TSharedPtr<SWidget> Draw() const override;
 };
 
 USTRUCT()
@@ -114,7 +91,7 @@ protected:
 	uint8 IndentLevel = 0;
 
 public:
-	TSharedPtr<SWidget> Draw() const override;
+	uint8 GetIndentLevel() const { return IndentLevel; }
 };
 
 // ================================================================================================
@@ -147,11 +124,20 @@ using BlockParserDelegate = TFunction<void(FRegexMatcher& Matcher, TArray<TInsta
 class FK2PostItAsyncParser : public TSharedFromThis<FK2PostItAsyncParser>
 {
 public:
-	FK2PostItAsyncParser(const FString& InString);
+	/** The parser shares the text with the caller, it is not copied. */
+	FK2PostItAsyncParser(const FText& InText);
+
+	/**
+	 * Version of the parsing rules. Bump it whenever a rule change alters the output for existing text,
+	 * documents stored by an older version are then re-parsed in the background after they load.
+	 */
+	static constexpr int32 Version = 1;
 	
 	void RunParser();
 	
 	static void PeasantTextToRichText(const FString& PeasantText, TArray<TInstancedStruct<FK2PostIt_BaseBlock>>& Blocks);
+
+	static void PeasantTextToRichText(const FString& PeasantText, FK2PostItDocument& Document);
 	
 	static void ProcessTextBlocks(FString RegexPattern, BlockParserDelegate F, TArray<TInstancedStruct<FK2PostIt_BaseBlock>>& Blocks);
 
@@ -159,7 +145,7 @@ public:
 
 	UE::Tasks::TTask<void> Task;
 
-	TMulticastDelegate<void(BlockArray)> OnParseComplete;
+	TMulticastDelegate<void(FK2PostItDocumentRef)> OnParseComplete;
 
-	FString StringToParse;
+	FText TextToParse;
 };
\ No newline at end of file
@@ -0,0 +1,53 @@
+// Unlicensed. This file is public domain.
+
+#pragma once
+
+#include "Containers/Array.h"
+#include "Containers/Map.h"
+#include "Containers/Ticker.h"
+#include "K2PostIt/K2PostItBlockWidgets.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+/**
+ * Recycles block widgets between nodes. Building a rich text block and its decorators is the most expensive part of drawing a comment,
+ * so widgets dropped by a rebuild or a closed graph are kept per block type and rebound to the next block of that type instead.
+ * Each type's free list is capped, and halved whenever the pool has gone unused for a while. Game thread only.
+ */
+class K2POSTIT_API FK2PostItBlockWidgetPool
+{
+public:
+	/** Returns a widget for Block, rebinding a pooled one if there is one. Use K2PostIt::BlockWidgets::DrawBlock. */
+	static TSharedRef<SWidget> Acquire(const FK2PostItBlockView& Block, const FK2PostItRenderContextRef& Context);
+
+	/** Hands a widget from Acquire back. Use K2PostIt::BlockWidgets::ReleaseBlock. */
+	static void Release(const TSharedRef<SWidget>& Widget);
+
+	/** Restyles a widget from Acquire. Use K2PostIt::BlockWidgets::RestyleBlock. */
+	static void Restyle(const TSharedRef<SWidget>& Widget);
+
+	/** Drops every widget the pool holds, pooled or handed out, and stops its ticker. Called on FCoreDelegates::OnPreExit, before Slate shuts down. */
+	static void Empty();
+
+protected:
+	static FK2PostItBlockWidgetPool& Get();
+
+	bool Tick(float DeltaTime);
+
+	void Recycle(FK2PostItBlockWidget&& Widget);
+
+	/** Widgets handed out by Acquire, by root widget */
+	TMap<const SWidget*, FK2PostItBlockWidget> InUse;
+
+	/** Unbound widgets, indexed by EK2PostItBlockType */
+	TArray<FK2PostItBlockWidget> Free[K2PostIt::NumBlockTypes];
+
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	/** Set by Acquire, cleared by Tick. The pool is only trimmed after a tick interval without use. */
+	bool bUsedSinceTick = false;
+};
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,86 @@
+// Unlicensed. This file is public domain.
+
+#pragma once
+
+#include "K2PostIt/K2PostItDocument.h"
+#include "K2PostIt/K2PostItRenderContext.h"
+#include "Templates/SharedPointer.h"
+
+class SBorder;
+class SRichTextBlock;
+class SWidget;
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+/**
+ * A block widget together with the parts of it that change when it is bound to a different block or its node's colors change.
+ * Nothing in it reads the render context from an attribute lambda, so it only repaints when it was actually changed and can sit in an invalidation panel.
+ */
+struct FK2PostItBlockWidget
+{
+	EK2PostItBlockType Type = EK2PostItBlockType::Text;
+
+	TSharedPtr<SWidget> Root;
+
+	TSharedRef<FK2PostItBlockBinding> Binding = MakeShared<FK2PostItBlockBinding>();
+
+	/** The block's text, not set for separators */
+	TSharedPtr<SRichTextBlock> Text;
+
+	/** Bullets only */
+	TSharedPtr<SRichTextBlock> BulletSymbol;
+
+	/** Bullets only, its padding holds the indent */
+	TSharedPtr<SBorder> IndentBorder;
+
+	/** Takes the comment color, its colors are set by StyleBlock */
+	TSharedPtr<SBorder> Border;
+
+	/** Code blocks only, the outline around the code */
+	TSharedPtr<SBorder> InnerBorder;
+
+	/** The comment color the widget was last styled with */
+	FLinearColor StyledColor = FLinearColor::Transparent;
+};
+
+// ------------------------------------------------------------------------------------------------
+
+namespace K2PostIt
+{
+	namespace BlockWidgets
+	{
+		/**
+		 * Returns the widget for one block of a parsed document, reusing a pooled widget of the same type when there is one. The widget reads colors and wrap
+		 * width from Context, the block itself is only read here. Hand the widget back with ReleaseBlock once it has been removed from its parent.
+		 */
+		K2POSTIT_API TSharedRef<SWidget> DrawBlock(const FK2PostItBlockView& Block, const FK2PostItRenderContextRef& Context);
+
+		/** Returns a widget from DrawBlock to the pool. It must no longer be in a panel. */
+		K2POSTIT_API void ReleaseBlock(const TSharedRef<SWidget>& Widget);
+
+		/** Reapplies the colors and wrap width of the widget's render context, call it after FK2PostItRenderContext::Update reports a change. */
+		K2POSTIT_API void RestyleBlock(const TSharedRef<SWidget>& Widget);
+
+		/** Identifies the widget DrawBlock builds for a block: blocks with equal keys get identical widgets, so a widget can be kept when its block survives a re-parse. */
+		K2POSTIT_API uint64 GetBlockKey(const FK2PostItBlockView& Block);
+
+		/** Rough height of the widget DrawBlock would build for Block when wrapped at WrapAt, from its line count. Used before the widget has been measured. */
+		K2POSTIT_API float EstimateBlockHeight(const FK2PostItBlockView& Block, float WrapAt);
+
+		/** Builds an unbound widget for blocks of Widget.Type. Used by FK2PostItBlockWidgetPool. */
+		void BuildBlock(FK2PostItBlockWidget& Widget);
+
+		/** Points a widget from BuildBlock at Block and Context. Used by FK2PostItBlockWidgetPool. */
+		void BindBlock(FK2PostItBlockWidget& Widget, const FK2PostItBlockView& Block, const FK2PostItRenderContextRef& Context);
+
+		/** Applies the colors and wrap width of the widget's bound context. Used by FK2PostItBlockWidgetPool. */
+		void StyleBlock(FK2PostItBlockWidget& Widget);
+
+		/** Drops the widget's text and context while it waits in the pool. Used by FK2PostItBlockWidgetPool. */
+		void UnbindBlock(FK2PostItBlockWidget& Widget);
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
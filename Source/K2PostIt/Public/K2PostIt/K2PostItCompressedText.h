@@ -0,0 +1,54 @@
+// Unlicensed. This file is public domain.
+
+#pragma once
+
+#include "Containers/Array.h"
+#include "Containers/StringView.h"
+#include "Containers/UnrealString.h"
+
+class FArchive;
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+/**
+ * Comment body text held as compressed UTF-8. Long comment bodies are saved in this form, and nodes that are not shown in any graph
+ * keep their body in it while in memory.
+ */
+class K2POSTIT_API FK2PostItCompressedText
+{
+public:
+	/** Returns true if a body of this length is long enough to be worth compressing, see UK2PostItProjectSettings::GetCompressionThreshold. */
+	static bool ShouldCompress(int32 TextLength);
+
+	/** Writes Text to the archive, compressed if bCompress is set and compressing actually makes it smaller. */
+	static void Save(FArchive& Ar, FStringView Text, bool bCompress);
+
+	/** Writes the already compressed text. The stored form is the same as Save with compression. */
+	void Save(FArchive& Ar) const;
+
+	/** Reads text written by either Save. If it was stored compressed, OutCompressed is given the compressed form so it need not be compressed again. */
+	static bool Load(FArchive& Ar, FString& OutText, FK2PostItCompressedText& OutCompressed);
+
+	/** Returns false, leaving this empty, if the compressed form would not be smaller. */
+	bool Compress(FStringView Text);
+
+	FString Decompress() const;
+
+	bool IsEmpty() const { return Data.IsEmpty(); }
+
+	void Reset();
+
+	int32 GetCompressedSize() const { return Data.Num(); }
+
+	int32 GetUncompressedSize() const { return UncompressedSize; }
+
+protected:
+	TArray<uint8> Data;
+
+	/** Length of the UTF-8 text in bytes */
+	int32 UncompressedSize = 0;
+};
+
+#undef LOCTEXT_NAMESPACE
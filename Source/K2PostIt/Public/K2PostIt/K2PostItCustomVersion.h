@@ -0,0 +1,45 @@
+// Unlicensed. This file is public domain.
+
+#pragma once
+
+#include "Misc/Guid.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+/** Versions of the K2PostIt node's custom serialized data. */
+struct K2POSTIT_API FK2PostItCustomVersion
+{
+	enum Type
+	{
+		/** Parsed blocks were saved as a tagged array of instanced structs */
+		BeforeCustomVersionWasAdded = 0,
+
+		/** Parsed blocks are saved as a compact binary document, see FK2PostItDocument::Serialize */
+		CompactDocument,
+
+		/** The compact document records the version of the parser rules that produced it */
+		ParserVersionStamp,
+
+		/** The comment body is saved as a plain string instead of the localizable CommentText property */
+		CommentBodyString,
+
+		/** Long comment bodies are saved compressed, see FK2PostItCompressedText */
+		CompressedCommentBody,
+
+		/** Nodes save the past versions of their comment body, see FK2PostItRevisionHistory */
+		RevisionHistory,
+
+		// -----<new versions can be added above this line>-----
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	static const FGuid GUID;
+
+private:
+	FK2PostItCustomVersion() {}
+};
+
+#undef LOCTEXT_NAMESPACE
@@ -4,20 +4,18 @@
 
 #include "Components/RichTextBlockDecorator.h"
 
-#include "K2PostIt/Widgets/SGraphNode_K2PostIt.h"
-
-class UEdGraphNode_K2PostIt;
+#include "K2PostIt/K2PostItRenderContext.h"
 
 class K2POSTIT_API  FK2PostItDecorator_InlineCode : public ITextDecorator
 {
 public:
-	FK2PostItDecorator_InlineCode(FString InName, TSharedPtr<SGraphNode_K2PostIt> InOwnerWidget);
+	FK2PostItDecorator_InlineCode(FString InName, FK2PostItBlockBindingRef InBinding);
 	
 	bool Supports( const FTextRunParseResults& RunInfo, const FString& Text ) const override;
 
-	static TSharedRef<FK2PostItDecorator_InlineCode> Create(FString InName, TSharedPtr<SGraphNode_K2PostIt> InOwnerWidget)
+	static TSharedRef<FK2PostItDecorator_InlineCode> Create(FString InName, FK2PostItBlockBindingRef InBinding)
 	{
-		return MakeShareable(new FK2PostItDecorator_InlineCode(MoveTemp(InName), InOwnerWidget));
+		return MakeShareable(new FK2PostItDecorator_InlineCode(MoveTemp(InName), InBinding));
 	}
 
 	//TSharedRef<ISlateRun> Create(const TSharedRef<class FTextLayout>& TextLayout, const FTextRunParseResults& RunInfo, const FString& OriginalText, const TSharedRef<FString>& ModelText, const ISlateStyle* Style) override;
@@ -29,7 +27,6 @@ public:
 
 	const FTextBlockStyle& TextStyle;
 
-	TWeakPtr<SGraphNode_K2PostIt> OwnerWidget;
-
-	UEdGraphNode_K2PostIt* GetOwner() const;
+	/** Shared with the block widget that owns this decorator */
+	FK2PostItBlockBindingRef Binding;
 };
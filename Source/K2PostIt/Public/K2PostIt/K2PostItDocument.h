@@ -0,0 +1,267 @@
+// Unlicensed. This file is public domain.
+
+#pragma once
+
+#include "Containers/Array.h"
+#include "Containers/ArrayView.h"
+#include "Containers/StringView.h"
+#include "Containers/UnrealString.h"
+#include "HAL/Platform.h"
+#include "Templates/SharedPointer.h"
+#include "Runtime/Launch/Resources/Version.h"
+
+#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION < 5
+#include "InstancedStruct.h"
+#else
+#include "StructUtils/InstancedStruct.h"
+#endif
+
+class FArchive;
+
+struct FK2PostIt_BaseBlock;
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+enum class EK2PostItBlockType : uint8
+{
+	Text,
+	Separator,
+	Code,
+	Bullet,
+};
+
+namespace K2PostIt
+{
+	/** Number of EK2PostItBlockType entries, for tables indexed by block type. Follows the last entry. */
+	constexpr int32 NumBlockTypes = static_cast<int32>(EK2PostItBlockType::Bullet) + 1;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+enum class EK2PostItSpanType : uint8
+{
+	Header1,
+	Header2,
+	Header3,
+	Code,
+	Link,
+	BoldItalic,
+	Bold,
+	Italic,
+	Underline,
+};
+
+// ------------------------------------------------------------------------------------------------
+
+/** One parsed block. The text is a range of the owning document's buffer and holds the rich text markup for the block. */
+struct FK2PostItBlockRecord
+{
+	int32 TextStart = 0;
+
+	int32 TextLen = 0;
+
+	int32 FirstSpan = 0;
+
+	int32 NumSpans = 0;
+
+	EK2PostItBlockType Type = EK2PostItBlockType::Text;
+
+	uint8 IndentLevel = 0;
+
+	bool operator==(const FK2PostItBlockRecord& Other) const
+	{
+		return TextStart == Other.TextStart && TextLen == Other.TextLen && FirstSpan == Other.FirstSpan && NumSpans == Other.NumSpans && Type == Other.Type && IndentLevel == Other.IndentLevel;
+	}
+};
+
+// ------------------------------------------------------------------------------------------------
+
+/** One inline styled run. The range covers the visible content of the run (inside the markup tags), in document buffer coordinates. */
+struct FK2PostItSpanRecord
+{
+	int32 ContentStart = 0;
+
+	int32 ContentLen = 0;
+
+	EK2PostItSpanType Type = EK2PostItSpanType::Bold;
+
+	bool operator==(const FK2PostItSpanRecord& Other) const
+	{
+		return ContentStart == Other.ContentStart && ContentLen == Other.ContentLen && Type == Other.Type;
+	}
+};
+
+// ================================================================================================
+
+class FK2PostItDocument;
+
+/** Lightweight read-only handle to one block of a document. Only valid while the document is alive and unmodified. */
+class FK2PostItBlockView
+{
+public:
+	FK2PostItBlockView(const FK2PostItDocument& InDocument, const FK2PostItBlockRecord& InRecord)
+		: Document(InDocument)
+		, Record(InRecord)
+	{}
+
+	EK2PostItBlockType GetType() const { return Record.Type; }
+
+	uint8 GetIndentLevel() const { return Record.IndentLevel; }
+
+	FStringView GetText() const;
+
+	TConstArrayView<FK2PostItSpanRecord> GetSpans() const;
+
+	FStringView GetSpanText(const FK2PostItSpanRecord& Span) const;
+
+	const FK2PostItBlockRecord& GetRecord() const { return Record; }
+
+protected:
+	const FK2PostItDocument& Document;
+
+	const FK2PostItBlockRecord& Record;
+};
+
+// ================================================================================================
+
+/**
+ * Flat representation of a parsed comment: all block text lives in one contiguous buffer, blocks and inline spans are packed records pointing into it.
+ * Compared to an array of instanced structs this is three allocations per document regardless of block count, and traversal is linear in memory.
+ */
+class K2POSTIT_API FK2PostItDocument
+{
+	friend class FK2PostItBlockView;
+
+public:
+	void Reset();
+
+	/** Appends a block. Inline spans are found by scanning the markup that the parser produced. */
+	void AddBlock(EK2PostItBlockType Type, FStringView Markup, uint8 IndentLevel = 0);
+
+	/** Releases slack left over from building the document. */
+	void Shrink();
+
+	int32 Num() const { return Blocks.Num(); }
+
+	bool IsEmpty() const { return Blocks.IsEmpty(); }
+
+	FK2PostItBlockView GetBlock(int32 Index) const { return FK2PostItBlockView(*this, Blocks[Index]); }
+
+	SIZE_T GetAllocatedSize() const;
+
+	/** Hash of the document's text and structure, equal documents hash equally. */
+	uint64 GetContentHash() const;
+
+	bool operator==(const FK2PostItDocument& Other) const;
+
+	bool operator!=(const FK2PostItDocument& Other) const { return !(*this == Other); }
+
+	/** Converts from the instanced struct blocks used while parsing and by older assets. */
+	static FK2PostItDocument FromBlocks(const TArray<TInstancedStruct<FK2PostIt_BaseBlock>>& InBlocks);
+
+	/** Converts back to instanced struct blocks. */
+	TArray<TInstancedStruct<FK2PostIt_BaseBlock>> ToBlocks() const;
+
+	/**
+	 * Compact binary form used by the node's custom serialization. Block text that appears verbatim in SourceText (the raw comment) is stored as a range of it,
+	 * anything else as UTF-8. Spans are not stored, they are rebuilt when loading.
+	 */
+	void Save(FArchive& Ar, FStringView SourceText) const;
+
+	/**
+	 * Reads the form written by Save. DataVersion is the FK2PostItCustomVersion the data was written with.
+	 * Returns false if the data does not belong to SourceText, the document is left empty.
+	 */
+	bool Load(FArchive& Ar, FStringView SourceText, int32 DataVersion);
+
+	/** Version of the parser rules that produced this document, see FK2PostItAsyncParser::Version. Zero if unknown. */
+	int32 GetParserVersion() const { return ParserVersion; }
+
+	void SetParserVersion(int32 InParserVersion) { ParserVersion = InParserVersion; }
+
+	/** Shared empty document, used as the initial value of document references. */
+	static TSharedRef<const FK2PostItDocument> GetEmpty();
+
+public:
+	struct FConstIterator
+	{
+		FConstIterator(const FK2PostItDocument& InDocument, int32 InIndex) : Document(InDocument), Index(InIndex) {}
+
+		FK2PostItBlockView operator*() const { return Document.GetBlock(Index); }
+
+		FConstIterator& operator++() { ++Index; return *this; }
+
+		bool operator!=(const FConstIterator& Other) const { return Index != Other.Index; }
+
+	private:
+		const FK2PostItDocument& Document;
+
+		int32 Index;
+	};
+
+	FConstIterator begin() const { return FConstIterator(*this, 0); }
+
+	FConstIterator end() const { return FConstIterator(*this, Blocks.Num()); }
+
+protected:
+	void ScanSpans(FK2PostItBlockRecord& Record);
+
+	FString Buffer;
+
+	TArray<FK2PostItBlockRecord> Blocks;
+
+	TArray<FK2PostItSpanRecord> Spans;
+
+	int32 ParserVersion = 0;
+};
+
+/** Documents are immutable once built, so the node, the parser, the parse cache and edit snapshots all share them by reference. */
+using FK2PostItDocumentRef = TSharedRef<const FK2PostItDocument>;
+
+using FK2PostItDocumentPtr = TSharedPtr<const FK2PostItDocument>;
+
+// ================================================================================================
+
+template<EK2PostItBlockType InType>
+struct TK2PostItBlockTag
+{
+	static constexpr EK2PostItBlockType Type = InType;
+};
+
+// ------------------------------------------------------------------------------------------------
+
+namespace K2PostIt
+{
+	/**
+	 * Calls Visitor(TK2PostItBlockTag<Type>(), Block) with the block type as a compile-time constant.
+	 * Visitors are written as templates (or generic lambdas) and get one instantiation per block type instead of virtual dispatch.
+	 */
+	template<typename VisitorType>
+	decltype(auto) VisitBlock(const FK2PostItBlockView& Block, VisitorType&& Visitor)
+	{
+		switch (Block.GetType())
+		{
+			case EK2PostItBlockType::Separator:
+			{
+				return Visitor(TK2PostItBlockTag<EK2PostItBlockType::Separator>(), Block);
+			}
+			case EK2PostItBlockType::Code:
+			{
+				return Visitor(TK2PostItBlockTag<EK2PostItBlockType::Code>(), Block);
+			}
+			case EK2PostItBlockType::Bullet:
+			{
+				return Visitor(TK2PostItBlockTag<EK2PostItBlockType::Bullet>(), Block);
+			}
+			case EK2PostItBlockType::Text:
+			default:
+			{
+				return Visitor(TK2PostItBlockTag<EK2PostItBlockType::Text>(), Block);
+			}
+		}
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
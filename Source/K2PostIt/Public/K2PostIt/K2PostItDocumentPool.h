@@ -0,0 +1,54 @@
+// Unlicensed. This file is public domain.
+
+#pragma once
+
+#include "Containers/Map.h"
+#include "HAL/CriticalSection.h"
+#include "K2PostIt/K2PostItDocument.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+/**
+ * Session-wide, thread-safe interning pool for parsed documents. Boilerplate headers, duplicated nodes and comments pasted between
+ * blueprints all parse to the same document, interning lets every node that shows it share one copy.
+ * The pool only holds weak references: a document lives as long as something other than the pool uses it.
+ */
+class K2POSTIT_API FK2PostItDocumentPool
+{
+public:
+	/** Returns the pooled document equal to Document and stamped with the same parser version, adding Document to the pool if there is none. */
+	static FK2PostItDocumentRef Intern(FK2PostItDocumentRef Document);
+
+	struct FStats
+	{
+		/** Distinct documents alive in the pool */
+		int32 NumDocuments = 0;
+
+		/** References to pooled documents, from nodes, edit snapshots and the parse cache */
+		int32 NumReferences = 0;
+
+		SIZE_T AllocatedBytes = 0;
+
+		/** Bytes that would be allocated if every reference held its own copy, minus AllocatedBytes */
+		SIZE_T SavedBytes = 0;
+	};
+
+	static FStats GetStats();
+
+protected:
+	static FK2PostItDocumentPool& Get();
+
+	/** Drops entries whose documents have been destroyed. Expects Lock to be held. */
+	void Prune();
+
+	FCriticalSection Lock;
+
+	TMultiMap<uint64, TWeakPtr<const FK2PostItDocument>> Entries;
+
+	/** Interns since the last prune, pruning is amortized against these */
+	int32 NumAddsSincePrune = 0;
+};
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,44 @@
+// Unlicensed. This file is public domain.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "K2PostItFuzzCommandlet.generated.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+/**
+ * Mutation fuzzer for the comment parser. Seeds come from Resources/FuzzCorpus and the plugin README, plus every input found by earlier runs.
+ *
+ *   UnrealEditor-Cmd <Project> -run=K2PostItFuzz [-Iterations=10000] [-Seed=N] [-MaxLength=16384]
+ *   UnrealEditor-Cmd <Project> -run=K2PostItFuzz -Input=<File>
+ *
+ * Findings are written to Saved/K2PostIt/Fuzz: Failures holds inputs whose document did not survive a save and load, Slow those that parsed slower than
+ * UK2PostItProjectSettings::GetSlowParseThreshold allows, and Crashes the input the parser was working on when a previous run died. The second form replays
+ * one input. Returns 1 if any input failed.
+ */
+UCLASS()
+class UK2PostItFuzzCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UK2PostItFuzzCommandlet();
+
+	int32 Main(const FString& Params) override;
+};
+
+// ------------------------------------------------------------------------------------------------
+
+namespace K2PostIt::Fuzz
+{
+	/**
+	 * Checks one UTF-8 input, asserting if it fails. It has the signature of LLVMFuzzerTestOneInput so a libFuzzer or AFL driver built against the
+	 * editor can forward to it as is, the assert is what those tools see as a crash.
+	 */
+	K2POSTIT_API int32 TestOneInput(const uint8* Data, SIZE_T Size);
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,62 @@
+// Unlicensed. This file is public domain.
+
+#pragma once
+
+#include "Containers/Array.h"
+#include "Containers/Set.h"
+#include "Containers/Ticker.h"
+#include "Layout/SlateRect.h"
+#include "SNodePanel.h"
+#include "Templates/SharedPointer.h"
+
+class SGraphNode_K2PostIt;
+class SGraphPanel;
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+/**
+ * Watches the view, zoom and selection of the graph panels showing comment nodes, and tells their nodes when these change.
+ * The graph has no events for them, so each panel is checked once per frame here instead of every node checking from its own Tick.
+ */
+class K2POSTIT_API FK2PostItGraphViewTracker
+{
+public:
+	/** Called by the node as it is added to the panel. The node gets its first OnGraphViewChanged and OnSelectionChanged on the next tick. */
+	static void Register(const TSharedRef<SGraphPanel>& Panel, const TSharedRef<SGraphNode_K2PostIt>& Node);
+
+	/** Pushes the current view to the node again on the next tick, for when the node itself moved, resized or rebuilt its body */
+	static void Refresh(const TSharedRef<SGraphNode_K2PostIt>& Node);
+
+protected:
+	static FK2PostItGraphViewTracker& Get();
+
+	bool Tick(float DeltaTime);
+
+	struct FPanelView
+	{
+		TWeakPtr<SGraphPanel> Panel;
+
+		TArray<TWeakPtr<SGraphNode_K2PostIt>> Nodes;
+
+		/** Nodes to push the view to on the next tick even if the view did not change */
+		TSet<TWeakPtr<SGraphNode_K2PostIt>> DirtyNodes;
+
+		EGraphRenderingLOD::Type LOD = EGraphRenderingLOD::DefaultDetail;
+
+		/** The part of the graph in view, in graph coordinates */
+		FSlateRect ViewRect;
+
+		/** Only compared against, never dereferenced */
+		FGraphPanelSelectionSet SelectedNodes;
+	};
+
+	FPanelView* FindPanelView(const SGraphPanel* Panel);
+
+	TArray<FPanelView> PanelViews;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+};
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,44 @@
+// Unlicensed. This file is public domain.
+
+#pragma once
+
+#include "Containers/LruCache.h"
+#include "Containers/StringView.h"
+#include "HAL/CriticalSection.h"
+#include "Hash/Blake3.h"
+#include "K2PostIt/K2PostItDocument.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+/**
+ * Bounded, thread-safe cache of parse results keyed by the comment text they were parsed from.
+ * The parsed document is derived state that is kept out of the undo buffer, this lets nodes get it back after undo/redo without re-parsing.
+ */
+class K2POSTIT_API FK2PostItParseCache
+{
+public:
+	/** Returns the cached document for SourceText, or null on a miss. */
+	static FK2PostItDocumentPtr Find(FStringView SourceText);
+
+	/** Caches Document for SourceText. If an equal document from the same parser version is already cached for it, that one is returned so callers can share it instead of keeping their own. */
+	static FK2PostItDocumentRef Add(FStringView SourceText, FK2PostItDocumentRef Document);
+
+	static void Empty();
+
+protected:
+	FK2PostItParseCache();
+
+	static FK2PostItParseCache& Get();
+
+	/** Entries are keyed on a cryptographic hash of the source, which stands in for the text: a different comment hashing the same is not a practical concern */
+	static FBlake3Hash HashSource(FStringView SourceText);
+
+	FCriticalSection Lock;
+
+	/** Documents are never null */
+	TLruCache<FBlake3Hash, FK2PostItDocumentPtr> Entries;
+};
+
+#undef LOCTEXT_NAMESPACE
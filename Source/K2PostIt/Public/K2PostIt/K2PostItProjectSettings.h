@@ -6,6 +6,17 @@
 
 #include "K2PostItProjectSettings.generated.h"
 
+/** Graph zoom levels, from the furthest out. Matches the order of EGraphRenderingLOD, after Never. */
+UENUM()
+enum class EK2PostItZoomDetail : uint8
+{
+	Never,
+	Lowest,
+	Low,
+	Medium,
+	Default,
+};
+
 UCLASS(Config = Editor, DefaultConfig, DisplayName = "K2 PostIt")
 class UK2PostItProjectSettings : public UDeveloperSettings
 {
@@ -30,6 +41,46 @@ protected:
 	UPROPERTY(Config, EditAnywhere, Category = "K2 PostIt")
 	bool bDisableMarkdownByDefault = false;
 
+	/** Parses slower than this are reported to the log. The per-character allowance below is added on top of this. */
+	UPROPERTY(Config, EditAnywhere, Category = "K2 PostIt|Diagnostics", meta=(ClampMin=1, Units="ms"))
+	float SlowParseBaseThreshold = 50.0f;
+
+	/** Extra time allowed per 1000 characters of comment text before a parse is reported as slow. */
+	UPROPERTY(Config, EditAnywhere, Category = "K2 PostIt|Diagnostics", meta=(ClampMin=0, Units="ms"))
+	float SlowParseThresholdPerKiloChar = 10.0f;
+
+	/** If set, the source text of any slow parse is written to Saved/K2PostIt/SlowParses so it can be reproduced. */
+	UPROPERTY(Config, EditAnywhere, Category = "K2 PostIt|Diagnostics")
+	bool bSaveSlowParseInputs = false;
+
+	/** Comment bodies at least this many characters long are saved compressed, and kept compressed in memory while no graph is showing them. 0 disables compression. */
+	UPROPERTY(Config, EditAnywhere, Category = "K2 PostIt|Storage", meta=(ClampMin=0))
+	int32 CompressionThreshold = 2048;
+
+	/** If set, every node keeps past versions of its comment body, saved with the blueprint as small deltas against the current one. */
+	UPROPERTY(Config, EditAnywhere, Category = "K2 PostIt|Revision History")
+	bool bKeepRevisionHistory = false;
+
+	/** Most past versions kept per node, the oldest are dropped first. */
+	UPROPERTY(Config, EditAnywhere, Category = "K2 PostIt|Revision History", meta=(ClampMin=1, EditCondition="bKeepRevisionHistory"))
+	int32 MaxRevisions = 32;
+
+	/** Most memory the revision history of one node may use, the oldest versions are dropped first. */
+	UPROPERTY(Config, EditAnywhere, Category = "K2 PostIt|Revision History", meta=(ClampMin=0, Units="Bytes", EditCondition="bKeepRevisionHistory"))
+	int32 RevisionHistoryByteBudget = 16 * 1024;
+
+	/** At this graph zoom level and further out, comment bodies only show their headings. */
+	UPROPERTY(Config, EditAnywhere, Category = "K2 PostIt|Performance")
+	EK2PostItZoomDetail OutlineZoomDetail = EK2PostItZoomDetail::Medium;
+
+	/** At this graph zoom level and further out, comments are drawn as a flat card showing only their title. */
+	UPROPERTY(Config, EditAnywhere, Category = "K2 PostIt|Performance")
+	EK2PostItZoomDetail CardZoomDetail = EK2PostItZoomDetail::Low;
+
+	/** Comment bodies that have been out of view this long give their markdown widgets back, and rebuild them when next in view. 0 keeps them for as long as the graph is open. */
+	UPROPERTY(Config, EditAnywhere, Category = "K2 PostIt|Performance", meta=(ClampMin=0, Units="s"))
+	float OffscreenBodyReleaseDelay = 30.0f;
+
 public:
 	static TArray<FLinearColor> GetQuickColorPaletteColors();
 
@@ -37,6 +88,25 @@ public:
 	
 	UFUNCTION()
 	static bool GetMarkdownDisabledByDefault() { return Get().bDisableMarkdownByDefault; }
+
+	/** Returns the parse time, in seconds, above which parsing a text of the given length is considered slow. */
+	static double GetSlowParseThreshold(int32 TextLength);
+
+	static bool GetSaveSlowParseInputs() { return Get().bSaveSlowParseInputs; }
+
+	static int32 GetCompressionThreshold() { return Get().CompressionThreshold; }
+
+	static bool GetKeepRevisionHistory() { return Get().bKeepRevisionHistory; }
+
+	static int32 GetMaxRevisions() { return Get().MaxRevisions; }
+
+	static int32 GetRevisionHistoryByteBudget() { return Get().RevisionHistoryByteBudget; }
+
+	static EK2PostItZoomDetail GetOutlineZoomDetail() { return Get().OutlineZoomDetail; }
+
+	static EK2PostItZoomDetail GetCardZoomDetail() { return Get().CardZoomDetail; }
+
+	static float GetOffscreenBodyReleaseDelay() { return Get().OffscreenBodyReleaseDelay; }
 	
 protected:
 	static const UK2PostItProjectSettings& Get();
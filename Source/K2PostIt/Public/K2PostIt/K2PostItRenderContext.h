@@ -0,0 +1,100 @@
+// Unlicensed. This file is public domain.
+
+#pragma once
+
+#include "Math/Color.h"
+#include "Templates/SharedPointer.h"
+
+class SGraphNode_K2PostIt;
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+/** Every color a node draws with, derived from its comment color once when that changes rather than by each widget while painting. */
+struct K2POSTIT_API FK2PostItTheme
+{
+	explicit FK2PostItTheme(const FLinearColor& InCommentColor = FLinearColor::White);
+
+	FLinearColor CommentColor;
+
+	/** Body and title text */
+	FLinearColor FontColor;
+
+	/** Bullet list text */
+	FLinearColor DimFontColor;
+
+	/** The title's placeholder while it is empty */
+	FLinearColor EmptyTitleColor;
+
+	FLinearColor SeparatorColor;
+
+	FLinearColor CodeBlockFillColor;
+
+	FLinearColor CodeBlockBorderColor;
+
+	FLinearColor InlineCodeFillColor;
+
+	FLinearColor InlineCodeBorderColor;
+
+	FLinearColor PreviewPaneColor;
+};
+
+// ------------------------------------------------------------------------------------------------
+
+/**
+ * Everything the block widgets of one node need while drawing: the owning widget, the comment color and the wrap width.
+ * Parsed documents stay pure data and can be shared between nodes and threads, each SGraphNode_K2PostIt owns one context and binds it into the widgets it builds.
+ */
+class K2POSTIT_API FK2PostItRenderContext
+{
+public:
+	FK2PostItRenderContext(TSharedPtr<SGraphNode_K2PostIt> InOwnerWidget);
+
+	/** Pulls the current comment color and wrap width from the owner. Returns true if either changed. Game thread only. */
+	bool Update();
+
+	TSharedPtr<SGraphNode_K2PostIt> GetOwnerWidget() const { return OwnerWidget.Pin(); }
+
+	const FLinearColor& GetCommentColor() const { return Theme.CommentColor; }
+
+	const FK2PostItTheme& GetTheme() const { return Theme; }
+
+	/** Width to wrap block text at, less an inset for indented blocks. Negative means don't wrap. */
+	float GetWrapAt(float Inset = 0.0f) const { return WrapAt < 0.0f ? WrapAt : WrapAt - Inset; }
+
+protected:
+	TWeakPtr<SGraphNode_K2PostIt> OwnerWidget;
+
+	FK2PostItTheme Theme;
+
+	float WrapAt = -1.0f;
+};
+
+using FK2PostItRenderContextRef = TSharedRef<const FK2PostItRenderContext>;
+
+using FK2PostItRenderContextPtr = TSharedPtr<const FK2PostItRenderContext>;
+
+// ------------------------------------------------------------------------------------------------
+
+/**
+ * What one block widget draws with: the render context of the node it currently belongs to, and the block's indent.
+ * Block widgets and their decorators read it through a shared binding instead of holding the context, so pooled widgets can be rebound to another node.
+ */
+class K2POSTIT_API FK2PostItBlockBinding
+{
+public:
+	/** The bound context, or a default one while the widget sits in the pool. */
+	const FK2PostItRenderContext& GetContext() const;
+
+	float GetWrapAt() const { return GetContext().GetWrapAt(WrapInset); }
+
+	FK2PostItRenderContextPtr Context;
+
+	/** Subtracted from the context's wrap width, for indented blocks */
+	float WrapInset = 0.0f;
+};
+
+using FK2PostItBlockBindingRef = TSharedRef<const FK2PostItBlockBinding>;
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,43 @@
+// Unlicensed. This file is public domain.
+
+#pragma once
+
+#include "Containers/Array.h"
+#include "Containers/Ticker.h"
+#include "HAL/CriticalSection.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class UEdGraphNode_K2PostIt;
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+/**
+ * Re-parses loaded nodes whose stored document is missing or was produced by an older parser version, and pasted nodes, which arrive without one.
+ * Nodes are parsed off the game thread in small batches, one batch at a time, so opening a large blueprint after a parser upgrade does not hitch the editor.
+ */
+class K2POSTIT_API FK2PostItReparseQueue
+{
+public:
+	/** Safe to call from any thread, including from PostLoad while loading asynchronously: nodes are held back until they have finished loading. Urgent nodes go ahead of the others and are all parsed in one parallel batch. */
+	static void Enqueue(UEdGraphNode_K2PostIt* Node, bool bUrgent = false);
+
+protected:
+	static FK2PostItReparseQueue& Get();
+
+	bool Tick(float DeltaTime);
+
+	FCriticalSection Lock;
+
+	TArray<TWeakObjectPtr<UEdGraphNode_K2PostIt>> Pending;
+
+	TArray<TWeakObjectPtr<UEdGraphNode_K2PostIt>> Urgent;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	/** Game thread only */
+	bool bBatchInFlight = false;
+};
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,64 @@
+// Unlicensed. This file is public domain.
+
+#pragma once
+
+#include "Containers/Array.h"
+#include "Containers/StringView.h"
+#include "Containers/UnrealString.h"
+#include "Misc/DateTime.h"
+
+class FArchive;
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+// ================================================================================================
+
+/**
+ * Past versions of a comment body, kept as reverse deltas: each revision stores what has to change in the next newer version
+ * (the current body, for the newest revision) to get it back. A delta is the changed middle of the text between an unchanged
+ * prefix and suffix, which for typical edits is a few words rather than a copy of the comment.
+ */
+class K2POSTIT_API FK2PostItRevisionHistory
+{
+public:
+	/** Records OldText as the newest revision, given that the body is now NewText. Drops the oldest revisions past the project settings' cap and byte budget. */
+	void Push(FStringView OldText, FStringView NewText);
+
+	/** Number of past versions, index 0 is the most recent one. */
+	int32 Num() const { return Revisions.Num(); }
+
+	bool IsEmpty() const { return Revisions.IsEmpty(); }
+
+	/** Rebuilds past version Index from the current body by applying the deltas from the newest back to it. */
+	FString GetRevision(FStringView CurrentText, int32 Index) const;
+
+	/** When the body was changed away from past version Index, in UTC. */
+	FDateTime GetTimestamp(int32 Index) const { return Revisions[Index].Timestamp; }
+
+	void Empty() { Revisions.Empty(); }
+
+	void Serialize(FArchive& Ar);
+
+	/** Approximate size of the history, as counted against the byte budget. */
+	int32 GetSize() const;
+
+protected:
+	struct FRevision
+	{
+		/** Characters at the start of the newer version that this one shares */
+		int32 PrefixLen = 0;
+
+		/** Characters at the end of the newer version that this one shares */
+		int32 SuffixLen = 0;
+
+		/** What this version has between the shared prefix and suffix */
+		FString Middle;
+
+		FDateTime Timestamp;
+	};
+
+	/** Newest first */
+	TArray<FRevision> Revisions;
+};
+
+#undef LOCTEXT_NAMESPACE
@@ -10,6 +10,9 @@
 #include "HAL/Platform.h"
 #include "Internationalization/Text.h"
 #include "K2Node.h"
+#include "K2PostIt/K2PostItCompressedText.h"
+#include "K2PostIt/K2PostItDocument.h"
+#include "K2PostIt/K2PostItRevisionHistory.h"
 #include "K2PostIt/Widgets/SGraphNode_K2PostIt.h"
 #include "Math/Color.h"
 #include "Runtime/Launch/Resources/Version.h"
@@ -80,25 +83,86 @@ public:
 	UPROPERTY()
 	int32 CommentDepth;
 
-	UPROPERTY()
-	FText CommentText;
-
 	FText PendingCommentText;
 
 protected:
-	UPROPERTY()
+	/**
+	 * The comment body. Comments are never localized, so this is not a property: it is saved as a plain string by Serialize and
+	 * copied through the clipboard by ExportCustomProperties, which keeps it out of localization gathering. Held as a culture invariant
+	 * FText so the editing widgets and the parser share it without copies. Empty while the body is in ColdCommentText, read it through GetCommentText.
+	 */
+	mutable FText CommentText;
+
+	/** The body, compressed, while no widget is showing this node and it is long enough to be worth it. */
+	mutable FK2PostItCompressedText ColdCommentText;
+
+	/** Number of graph node widgets currently showing this node */
+	int32 NumVisualWidgets = 0;
+
+	/** Past versions of the body, when UK2PostItProjectSettings::GetKeepRevisionHistory is set. Part of transactions so that it stays in step with CommentText. */
+	FK2PostItRevisionHistory RevisionHistory;
+
+public:
+	/** Returns the comment body, decompressing it if it was put away. Game thread only. */
+	const FText& GetCommentText() const;
+
+	bool HasCommentText() const { return !CommentText.IsEmpty() || !ColdCommentText.IsEmpty(); }
+
+	/** Past versions are rebuilt with GetRevisionHistory().GetRevision(GetCommentText().ToString(), Index). */
+	const FK2PostItRevisionHistory& GetRevisionHistory() const { return RevisionHistory; }
+
+	/** Called by SGraphNode_K2PostIt as it is constructed and destroyed. The body is compressed once the last widget is gone. */
+	void AddVisualWidget();
+
+	void RemoveVisualWidget();
+
+	/** Size of the body as UTF-8, in bytes. */
+	int32 GetCommentTextSize() const;
+
+	/** Size, in bytes, the body takes in a saved package with the current compression settings. */
+	int32 GetSavedCommentTextSize() const;
+
+protected:
+	/** Comment body of assets saved before FK2PostItCustomVersion::CommentBodyString. Moved into CommentText on load, never saved. */
+	UPROPERTY(TextExportTransient)
+	FText CommentText_DEPRECATED;
+
+	/** Parsed blocks as stored by assets saved before FK2PostItCustomVersion::CompactDocument. Only filled while loading those, the node keeps the parsed comment in Document. */
+	UPROPERTY(TextExportTransient)
 	TArray<TInstancedStruct<FK2PostIt_BaseBlock>> Blocks;
 
-	TArray<TInstancedStruct<FK2PostIt_BaseBlock>> PreTransactionBlocks;
+	/** Parsed CommentText. Derived state: it is not recorded in transactions and is restored from FK2PostItParseCache (or re-parsed) after undo/redo. */
+	FK2PostItDocumentRef Document = FK2PostItDocument::GetEmpty();
 
-	bool bPreTransactionBlocksSet = false;
+	/** The document from before the current edit started, restored if the edit is aborted. Shares the document, it is not a copy. */
+	FK2PostItDocumentPtr PreTransactionDocument;
 	
 public:
-	TArray<TInstancedStruct<FK2PostIt_BaseBlock>>& GetBlocks();
+	const FK2PostItDocument& GetBlocks() const;
+
+	FK2PostItDocumentRef GetDocument() const { return Document; }
 
 	//static 
 	//TArray<TInstancedStruct<FK2PostIt_BaseBlock>> PreviewBlocks;
 
+protected:
+	/** Height of the node as last laid out with its markdown showing, and the node width and font size it was laid out at. Lets a new widget size itself, and so be culled, before building its markdown. */
+	UPROPERTY(TextExportTransient)
+	float MeasuredHeight = 0.0f;
+
+	UPROPERTY(TextExportTransient)
+	int32 MeasuredAtWidth = 0;
+
+	UPROPERTY(TextExportTransient)
+	int32 MeasuredAtFontSize = 0;
+
+public:
+	/** Returns the last measured height if it was measured at Width and the current font size, otherwise 0. */
+	float GetMeasuredHeight(int32 Width) const;
+
+	/** Not transacted and does not dirty the package, the measurement is saved along with the next real change. */
+	void SetMeasuredHeight(int32 Width, float Height);
+
 protected:
 	bool bFirstPlaced = false;
 
@@ -114,15 +178,21 @@ protected:
 
 public:
 	TMulticastDelegate<void()> OnBlocksUpdatedEvent;
+
+	/** Broadcast when a property that changes how the node looks was edited or undone, such as its color, font size or bubble visibility */
+	TMulticastDelegate<void()> OnAppearanceChangedEvent;
 	
 public:
 
 	//~ Begin UObject Interface
+	void Serialize(FArchive& Ar) override;
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 	virtual bool IsSelectedInEditor() const override;
 
 	void PostLoad() override;
 	void PostEditUndo() override;
+	void ExportCustomProperties(FOutputDevice& Out, uint32 Indent) override;
+	void ImportCustomProperties(const TCHAR* SourceText, FFeedbackContext* Warn) override;
 	//~ End UObject Interface
 
 	//~ Begin UEdGraphNode Interface
@@ -134,6 +204,7 @@ public:
 	virtual FText GetPinNameOverride(const UEdGraphPin& Pin) const override;
 	virtual void ResizeNode(const FVector2D& NewSize) override;
 	virtual void PostPlacedNewNode() override;
+	virtual void PostPasteNode() override;
 	virtual void OnRenameNode(const FString& NewName) override;
 	virtual TSharedPtr<class INameValidatorInterface> MakeNameValidator() const override;
 	virtual FString GetDocumentationLink() const override;
@@ -164,9 +235,24 @@ public:
 	enum class ESelectionState : uint8 { Inherited, Selected, Deselected };
 	void SetSelectionState(const ESelectionState InSelectionState);
 
-	void OnParseComplete(TArray<TInstancedStruct<FK2PostIt_BaseBlock>> NewBlocks);
+	void OnParseComplete(FK2PostItDocumentRef NewDocument);
+
+	/** Called by FK2PostItReparseQueue with a fresh parse of SourceText for a node whose stored document was missing or stale. */
+	void ApplyReparsedDocument(const FString& SourceText, FK2PostItDocumentRef NewDocument);
 	
 private:
+	void StartParser(const FText& Text);
+
+	/** After load, takes a current document for the body from the parse cache or queues the node for a reparse. Game thread only. */
+	void RefreshLoadedDocument();
+
+	/** Moves the body into ColdCommentText if nothing is showing, parsing or editing it. */
+	void CompressCommentTextIfUnused();
+
+	/** Replaces the committed comment body, recording the old one in the revision history. */
+	void CommitCommentText(const FText& Text);
+
+
 	/** Constructing FText strings can be costly, so we cache the node's tooltip */
 	FNodeTextCache CachedTooltip;
 
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Containers/Array.h"
+#include "Containers/Ticker.h"
 #include "Containers/UnrealString.h"
 #include "Framework/Text/ITextDecorator.h"
 #include "Framework/Text/SlateWidgetRun.h"
@@ -19,6 +20,8 @@
 #include "Templates/SharedPointer.h"
 #include "Widgets/DeclarativeSyntaxSupport.h"
 
+class FK2PostItRenderContext;
+class SK2PostItBlockList;
 class SMultiLineEditableTextBox;
 class SBox;
 class SMultiLineEditableText;
@@ -27,6 +30,7 @@ class FDragDropEvent;
 class SBorder;
 class SCommentBubble;
 class SGraphNode;
+class SGraphPanel;
 class UEdGraphNode_K2PostIt;
 struct FGeometry;
 struct FPointerEvent;
@@ -42,7 +46,9 @@ public:
 	FReply OnMouseButtonDoubleClick( const FGeometry& InMyGeometry, const FPointerEvent& InMouseEvent ) override;
 	FReply OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
 	FReply OnMouseButtonUp( const FGeometry& MyGeometry, const FPointerEvent& MouseEvent ) override;
-	void Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) override;
+	FReply OnMouseMove(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	void OnMouseEnter(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	void OnFocusChanging(const FWeakWidgetPath& PreviousFocusPath, const FWidgetPath& NewWidgetPath, const FFocusEvent& InFocusEvent) override;
 	FReply OnDrop( const FGeometry& MyGeometry, const FDragDropEvent& DragDropEvent ) override;
 	void OnDragEnter( const FGeometry& MyGeometry, const FDragDropEvent& DragDropEvent ) override;
 	//~ SWidget Interface
@@ -61,6 +67,7 @@ public:
 	//~ SPanel Interface
 
 	//~ Begin SGraphNode Interface
+	void SetOwner(const TSharedRef<SGraphPanel>& OwnerPanel) override;
 	bool IsNameReadOnly() const override;
 	FSlateColor GetCommentColor() const override { return GetCommentBodyColor(); }
 	//~ SGraphNode Interface
@@ -73,6 +80,8 @@ public:
 	void OnParseComplete();
 	void Construct( const FArguments& InArgs, UEdGraphNode_K2PostIt* InNode );
 
+	~SGraphNode_K2PostIt();
+
 	/** return if the node can be selected, by pointing given location */
 	bool CanBeSelected( const FVector2D& MousePositionInNode ) const override;
 
@@ -133,12 +142,26 @@ public:
 	/** Returns the width to wrap the text of the comment at */
 	float GetWrapAt() const;
 
+	/** Called by FK2PostItGraphViewTracker when the graph's zoom or the part of it in view changed, ViewRect is in graph coordinates */
+	void OnGraphViewChanged(const FSlateRect& ViewRect);
+
+	/** Called by FK2PostItGraphViewTracker when the graph's selection changed */
+	void OnSelectionChanged(bool bSelected);
+
 private:
 	/** The comment bubble widget (used when zoomed out) */
 	TSharedPtr<SCommentBubble> CommentBubble;
 
 	TSharedPtr<SMultiLineEditableTextBox> CommentTextSource;
 
+	/** Holds CommentTextSource once it is built */
+	TSharedPtr<SBox> CommentTextSourceBox;
+
+	TSharedPtr<SWidget> EditButton;
+
+	/** Holds EditButton once it is built */
+	TSharedPtr<SBox> EditButtonBox;
+
 	bool bMouseClickEditingInterlock = false;
 
 	bool bEditButtonClicked = false;
@@ -163,11 +186,30 @@ private:
 
 	TSharedPtr<SWebBrowserView> WebBrowser;
 
-	TSharedPtr<SVerticalBox> FormattedTextPanel;
+	/** The rendered markdown, one widget per block near the graph's view */
+	TSharedPtr<SK2PostItBlockList> FormattedTextPanel;
 
+	/** The rendered markdown in the preview window while it is attached to this node, all blocks built. A widget has one parent, so FormattedTextPanel cannot be shown there. */
+	TSharedPtr<SK2PostItBlockList> PreviewTextPanel;
+
+	/** The comment's headings, shown instead of FormattedTextPanel when zoomed out, see UK2PostItProjectSettings::OutlineZoomDetail */
+	TSharedPtr<SVerticalBox> OutlinePanel;
+
+	/** Colors and wrap width for the block widgets in FormattedTextPanel and the node itself, refreshed when the node's appearance or width changes */
+	TSharedPtr<FK2PostItRenderContext> RenderContext;
+
+	/** Kept while hidden, see ShowQuickColorPalette */
 	TSharedPtr<SWidget> QuickColorPalette;
 
+	/** The project palette QuickColorPalette was built from */
+	TArray<FLinearColor> QuickColorPaletteColors;
+
+	bool bQuickColorPaletteShown = false;
+
 	TSharedPtr<SOverlay> TitleWidgetPanel;
+
+	/** The node this widget was counted against with AddVisualWidget, weak as the widget can outlive it */
+	TWeakObjectPtr<UEdGraphNode_K2PostIt> CountedNode;
 	
 	FSlateColor ForegroundColor_TitleBorder() const;
 
@@ -187,13 +229,81 @@ private:
 	/** cached comment title */
 	float CachedWidth = 0.0f;
 
+	/** Set while the markdown widgets have not been built yet because the node's height was already known, see UEdGraphNode_K2PostIt::GetMeasuredHeight */
+	bool bRichTextDeferred = false;
+
+	/** Whether the node overlapped the graph's view when it was last pushed, see OnGraphViewChanged */
+	bool bOnScreen = false;
+
+	/** When bOnScreen was last cleared */
+	double OffScreenSince = 0.0;
+
+	/** Runs ReleaseOffscreenBody while the markdown widgets are built, see UK2PostItProjectSettings::OffscreenBodyReleaseDelay */
+	FTSTicker::FDelegateHandle OffscreenBodyTicker;
+
+	/** Runs AnimatePreviewPanel while the preview panel is fading or open */
+	TWeakPtr<FActiveTimerHandle> PreviewPanelTimer;
+
+	/** Set when OutlinePanel no longer matches the parsed comment */
+	bool bOutlineDirty = true;
+
+	/** How much of the node is drawn at the graph's current zoom */
+	enum class EBodyDetail : uint8
+	{
+		Full,
+		Outline,
+		Card,
+	};
+
+	EBodyDetail ComputeBodyDetail() const;
+
+	/** The body detail as of the last OnGraphViewChanged. ComputeDesiredSize depends on it, so the node's layout is invalidated when it changes */
+	EBodyDetail CachedBodyDetail = EBodyDetail::Full;
+
 	/** Local copy of the comment style */
 	FInlineEditableTextBlockStyle CommentStyle;
 
 	void RebuildRichText();
+
+	void RebuildOutline();
+
+	/** Bound to FormattedTextPanel and PreviewTextPanel, index into the node's document */
+	TSharedRef<SWidget> GenerateBlockWidget(int32 Index);
+
+	float EstimateBlockHeight(int32 Index) const;
+
+	/** Releases the markdown widgets of a node that has been off screen for a while, leaving it deferred until it is drawn again */
+	bool ReleaseOffscreenBody(float DeltaTime);
+
+	/** Builds the widgets of the blocks of FormattedTextPanel that are in ViewRect, in graph coordinates */
+	void UpdateVisibleBlocks(const FSlateRect& ViewRect);
+
+	/** Lays out the markdown pane and stores its height with UEdGraphNode_K2PostIt::SetMeasuredHeight. Called wherever the pane's height may have changed. */
+	void StoreMeasuredHeight();
+
+	/** Refreshes RenderContext and restyles the block widgets if it changed */
+	void UpdateRenderContext();
+
+	/** One key per block of the node's document, see K2PostIt::BlockWidgets::GetBlockKey */
+	TArray<uint64> GetBlockKeys() const;
+
+	/** Takes the block widgets out of FormattedTextPanel and hands them back to the block widget pool */
+	void ReleaseBlockWidgets();
+
+	/** Build the node's rarely used widgets the first time they are needed */
+	void BuildCommentTextSource();
+
+	void BuildEditButton();
+
+	void BuildCommentBubble();
+
+	/** True if the node shows its source text instead of rendering it, see UK2PostItProjectSettings::bDisableMarkdownByDefault */
+	bool IsMarkdownDisabled() const;
 	
 	void ShowQuickColorPalette();
 
+	TSharedRef<SWidget> BuildQuickColorPalette(const TArray<FLinearColor>& Colors);
+
 	void HideQuickColorPalette();
 	
 	FReply OnClicked_QuickColorPaletteColor(const FLinearColor NewColor);
@@ -208,7 +318,22 @@ private:
 
 	int32 WidgetIndex_CommentTextPane() const;
 
+	int32 WidgetIndex_NodeBody() const;
+
 	void UpdatePreviewPanelOpacity();
+
+	void StartPreviewPanelAnimation();
+
+	/** Moves the preview window of the node's graph panel to this node, taking it from the node that had it */
+	void AttachPreviewPanel();
+
+	/** Gives the preview window back if this node has it */
+	void DetachPreviewPanel();
+
+	EActiveTimerReturnType AnimatePreviewPanel(double InCurrentTime, float InDeltaTime);
+
+	/** Bound to UEdGraphNode_K2PostIt::OnAppearanceChangedEvent */
+	void OnAppearanceChanged();
 	
 	/* Called when text is committed on the node */
 	void K2PostIt_OnNameTextCommited ( const FText& InText, ETextCommit::Type CommitInfo ) ;
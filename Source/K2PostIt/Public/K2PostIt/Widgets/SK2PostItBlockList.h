@@ -0,0 +1,108 @@
+// Unlicensed. This file is public domain.
+
+#pragma once
+
+#include "Containers/Array.h"
+#include "Containers/ArrayView.h"
+#include "Layout/Children.h"
+#include "Layout/SlateRect.h"
+#include "Templates/Function.h"
+#include "Widgets/DeclarativeSyntaxSupport.h"
+#include "Widgets/SPanel.h"
+
+#define LOCTEXT_NAMESPACE "K2PostIt"
+
+DECLARE_DELEGATE_RetVal_OneParam(TSharedRef<SWidget>, FOnGenerateK2PostItBlock, int32 /* Index */)
+DECLARE_DELEGATE_RetVal_OneParam(float, FOnEstimateK2PostItBlockHeight, int32 /* Index */)
+DECLARE_DELEGATE_OneParam(FOnReleaseK2PostItBlock, const TSharedRef<SWidget>&)
+
+// ================================================================================================
+
+/**
+ * Stacks the block widgets of a comment body like an SVerticalBox, but only holds widgets for the blocks near the visible part of the graph.
+ * The other blocks take up their last measured height, or an estimate until they have been shown once, so long comments lay out and paint what is in view.
+ */
+class K2POSTIT_API SK2PostItBlockList : public SPanel
+{
+public:
+	SLATE_BEGIN_ARGS(SK2PostItBlockList) {}
+
+		/** Builds the widget for the block at an index of the last SetBlocks */
+		SLATE_EVENT(FOnGenerateK2PostItBlock, OnGenerateBlock)
+
+		/** Takes back a widget from OnGenerateBlock once it has been removed from the list */
+		SLATE_EVENT(FOnReleaseK2PostItBlock, OnReleaseBlock)
+
+		/** Height a block is assumed to have until its widget has been measured */
+		SLATE_EVENT(FOnEstimateK2PostItBlockHeight, OnEstimateBlockHeight)
+
+	SLATE_END_ARGS()
+
+	SK2PostItBlockList();
+
+	void Construct(const FArguments& InArgs);
+
+	/** Replaces the blocks. Blocks whose key was already in the list keep their widget and measured height, see K2PostIt::BlockWidgets::GetBlockKey. */
+	void SetBlocks(TConstArrayView<uint64> Keys);
+
+	/** Removes every block and hands back their widgets */
+	void Reset();
+
+	/** Goes back to estimates for the blocks without a widget, for when the wrap width changed. Blocks with one are measured again at the next layout. */
+	void ResetMeasurements();
+
+	/** Builds the widgets of the blocks near the range Top to Bottom, in the list's own layout units, and hands back those well away from it. Returns true if any were added or removed. Does nothing if neither the range nor a block height changed since the last call. */
+	bool SetVisibleRange(float Top, float Bottom);
+
+	/** Calls Callback for every block that has a widget */
+	void ForEachWidget(TFunctionRef<void(const TSharedRef<SWidget>&)> Callback) const;
+
+	//~ Begin SWidget Interface
+	void OnArrangeChildren(const FGeometry& AllottedGeometry, FArrangedChildren& ArrangedChildren) const override;
+	FVector2D ComputeDesiredSize(float) const override;
+	FChildren* GetChildren() override;
+	//~ SWidget Interface
+
+private:
+	struct FBlock
+	{
+		uint64 Key = 0;
+
+		/** Only set while the block is near the visible rect */
+		TSharedPtr<SWidget> Widget;
+
+		/** Measured while the block has a widget, estimated until it first had one */
+		float Height = 0.0f;
+	};
+
+	/** Builds or hands back widgets to match the visible range */
+	bool UpdateWidgets();
+
+	void AddWidget(int32 Index);
+
+	void RemoveWidget(int32 Index);
+
+	float EstimateHeight(int32 Index) const;
+
+	/** Heights are stored when the widgets are measured in ComputeDesiredSize */
+	mutable TArray<FBlock> Blocks;
+
+	/** The widgets of Blocks, in no particular order */
+	TSlotlessChildren<SWidget> Children;
+
+	FOnGenerateK2PostItBlock OnGenerateBlock;
+
+	FOnReleaseK2PostItBlock OnReleaseBlock;
+
+	FOnEstimateK2PostItBlockHeight OnEstimateBlockHeight;
+
+	/** Local range of the list that is in view, assumed to be its top until SetVisibleRange knows better */
+	float VisibleTop = 0.0f;
+
+	float VisibleBottom;
+
+	/** Set when a block's height changed since the last UpdateWidgets, which moves the blocks below it in or out of the visible range */
+	mutable bool bHeightsChanged = false;
+};
+
+#undef LOCTEXT_NAMESPACE